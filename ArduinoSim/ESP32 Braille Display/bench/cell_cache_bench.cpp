@@ -0,0 +1,95 @@
+// Host benchmark for the name strip cache: translating every name of a 200 device menu without
+// it, building the menu from an empty cache, rebuilding it after one device was renamed and
+// switching between grade 1 and 2, in microseconds with the cache's hits and misses.
+//
+//   g++ -std=gnu++17 -O2 -Iinclude bench/cell_cache_bench.cpp src/Menu.cpp src/CellCache.cpp src/DeviceList.cpp src/BrailleTable.cpp src/Contractions.cpp -o cell_cache_bench
+//   ./cell_cache_bench
+
+#include "DeviceList.h"
+#include "Menu.h"
+#include "Contractions.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+static const char *const ROOMS[] = {
+  "Living Room", "Kitchen", "Main Bedroom", "Bedroom 2", "Bathroom", "Garage",
+  "Garden", "Study", "Laundry", "Dining Room"
+};
+static const char *const DEVICES[] = {
+  "Ceiling Light", "Lamp", "Smart Plug", "Air Conditioner", "Television", "Heater",
+  "Door Lock", "Curtains", "Fan", "Speaker"
+};
+
+//every room has the same kinds of device, twice: "Lamp" and "Lamp 2"
+static std::string payload(const char *renamed) {
+  std::string s;
+  for (int r = 0; r < 10; r++) {
+    if (r > 0) s += ',';
+    s += ROOMS[r];
+    s += '-';
+    for (int d = 0; d < 20; d++) {
+      if (d > 0) s += ';';
+      if (r == 3 && d == 7 && renamed != nullptr) {
+        s += renamed;
+        continue;
+      }
+      s += DEVICES[d % 10];
+      if (d >= 10) s += " 2";
+    }
+  }
+  return s;
+}
+
+static DeviceList list;
+static Menu menu;
+
+static void load(const std::string &text) {
+  memcpy(list.text, text.data(), text.size());
+  list.length = text.size();
+  parseDeviceList(list);
+}
+
+template <typename F>
+static void run(const char *name, int rounds, F build) {
+  CellCache &strips = const_cast<CellCache &>(menu.strips());
+  strips.resetCounters();
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) build(r);
+  double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / rounds;
+  uint32_t total = strips.hits() + strips.misses();
+  printf("%-24s %8.2f us/build, %5.1f%% hits (%u hits, %u misses)\n", name, us,
+         total ? 100.0 * strips.hits() / total : 0.0, strips.hits(), strips.misses());
+}
+
+int main() {
+  const int rounds = 2000;
+  CellCache &strips = const_cast<CellCache &>(menu.strips());
+  std::string before = payload(nullptr), after = payload("Reading Lamp");
+
+  load(before);
+  printf("%u devices in %u rooms\n", list.count, list.rooms);
+  run("no cache", rounds, [&](int) {
+    uint8_t cells[255];
+    for (uint16_t i = 0; i < list.count; i++) {
+      const DeviceEntry &e = list.entry[i];
+      if (i == 0 || e.room.offset != list.entry[i - 1].room.offset) {
+        translateContracted(UEB_CONTRACTIONS, list.at(e.room), e.room.len, cells, sizeof(cells));
+      }
+      translateContracted(UEB_CONTRACTIONS, list.at(e.device), e.device.len, cells, sizeof(cells));
+    }
+  });
+  run("from an empty cache", rounds, [&](int) {
+    strips.clear();
+    menu.build(list, TABLE_UEB_GRADE2);
+  });
+  run("one device renamed", rounds, [&](int r) {
+    load(r & 1 ? after : before);
+    menu.build(list, TABLE_UEB_GRADE2);
+  });
+  run("grade 1 <-> grade 2", rounds, [&](int r) { menu.build(list, r & 1 ? TABLE_UEB_GRADE2 : TABLE_GRADE1); });
+  printf("%u strips kept\n", strips.size());
+  return 0;
+}
@@ -0,0 +1,56 @@
+// Host benchmark for MD_MAX72XX column access: getColumn(), setColumn() and a clockwise
+// rotation on FC16 modules, whose digits are rows so a column is a bit of every digit, next to
+// the same calls on modules whose digits are columns. Nanoseconds per call, buffer only, with
+// a frame held open so nothing is sent. Build it twice to compare the 64 bit word kernels with
+// the bit at a time loops.
+//
+//   L=lib/MD_MAX72XX/src
+//   g++ -std=gnu++17 -O2 -Wno-cpp -Ihost -Iinclude -I$L -DUSE_BIT_TRANSPOSE=1 bench/column_bench.cpp host/Arduino.cpp host/VirtualDisplay.cpp src/BrailleLayout.cpp $L/*.cpp -o column_bench
+//   g++ -std=gnu++17 -O2 -Wno-cpp -Ihost -Iinclude -I$L -DUSE_BIT_TRANSPOSE=0 bench/column_bench.cpp host/Arduino.cpp host/VirtualDisplay.cpp src/BrailleLayout.cpp $L/*.cpp -o column_loop_bench
+//   ./column_bench; ./column_loop_bench
+
+#include <MD_MAX72xx.h>
+
+#include <chrono>
+#include <stdio.h>
+
+constexpr uint8_t DEVICES = 8;
+constexpr long CALLS = 4000000;
+
+template <typename F>
+static double nsPer(long n, F f) {
+  auto t0 = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+static volatile uint32_t sink;
+
+static void run(const char *name, MD_MAX72XX::moduleType_t mod) {
+  MD_MAX72XX mx(mod, 23, 18, 5, DEVICES);
+  mx.begin();
+  mx.beginFrame();
+
+  double setNs = nsPer(CALLS, [&] {
+    for (long i = 0; i < CALLS; i++) mx.setColumn(i % (DEVICES * COL_SIZE), (uint8_t)(i * 37));
+  });
+  double getNs = nsPer(CALLS, [&] {
+    uint32_t s = 0;
+    for (long i = 0; i < CALLS; i++) s += mx.getColumn(i % (DEVICES * COL_SIZE));
+    sink += s;
+  });
+  double rotateNs = nsPer(CALLS / 8, [&] {
+    for (long i = 0; i < CALLS / 8; i++) mx.transform(i % DEVICES, MD_MAX72XX::TRC);
+  });
+  printf("%-22s setColumn %5.1f ns, getColumn %5.1f ns, rotate %6.1f ns/device\n", name, setNs, getNs, rotateNs);
+
+  mx.commitFrame();
+}
+
+int main() {
+  printf("USE_BIT_TRANSPOSE %d\n", USE_BIT_TRANSPOSE);
+  run("FC16 (digits as rows)", MD_MAX72XX::FC16_HW);
+  run("GENERIC (digits as cols)", MD_MAX72XX::GENERIC_HW);
+  printf("(%u)\n", (unsigned)sink);
+  return 0;
+}
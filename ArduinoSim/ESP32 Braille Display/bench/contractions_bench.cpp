@@ -0,0 +1,63 @@
+// Host benchmark for the grade 2 translator: throughput in characters per microsecond
+// and how many cells contraction saves on the names we actually show.
+//
+//   g++ -std=gnu++17 -O2 -Iinclude bench/contractions_bench.cpp src/BrailleTable.cpp src/Contractions.cpp -o contractions_bench
+//   ./contractions_bench
+
+#include "BrailleTable.h"
+#include "Contractions.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+//room and device names from the demo list and the backend's device collection
+static const char *const CORPUS[] = {
+  "bathroom", "kitchen", "bedroom", "lights", "doorlocks", "thermostats", "locked", "unlocked",
+  "living room", "dining room", "garage", "garden", "study", "laundry", "main bedroom",
+  "ceiling fan", "air conditioner", "television", "washing machine", "front door", "back door",
+  "security camera", "smart plug", "heater", "geyser", "curtains", "dishwasher", "sprinkler",
+  "kettle", "alarm", "motion sensor", "under floor heating", "reading light", "on", "off"
+};
+static const size_t CORPUS_SIZE = sizeof(CORPUS) / sizeof(CORPUS[0]);
+
+int main() {
+  const int rounds = 20000;
+  uint8_t cells[64];
+  size_t chars = 0;
+  size_t grade1 = 0;
+  size_t grade2 = 0;
+
+  for (size_t i = 0; i < CORPUS_SIZE; i++) {
+    size_t len = strlen(CORPUS[i]);
+    chars += len;
+    grade1 += translateText(CORPUS[i], len, cells, sizeof(cells));
+    grade2 += translateContracted(UEB_CONTRACTIONS, CORPUS[i], len, cells, sizeof(cells));
+  }
+
+  volatile size_t sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < CORPUS_SIZE; i++) {
+      sink += translateText(CORPUS[i], strlen(CORPUS[i]), cells, sizeof(cells));
+    }
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < CORPUS_SIZE; i++) {
+      sink += translateContracted(UEB_CONTRACTIONS, CORPUS[i], strlen(CORPUS[i]), cells, sizeof(cells));
+    }
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  double us1 = std::chrono::duration<double, std::micro>(t1 - t0).count();
+  double us2 = std::chrono::duration<double, std::micro>(t2 - t1).count();
+  double total = (double)chars * rounds;
+
+  printf("corpus: %zu names, %zu characters\n", CORPUS_SIZE, chars);
+  printf("grade 1: %8.1f chars/us, %zu cells\n", total / us1, grade1);
+  printf("grade 2: %8.1f chars/us, %zu cells\n", total / us2, grade2);
+  printf("cells saved per name: %.2f (%.1f%%)\n", (double)(grade1 - grade2) / CORPUS_SIZE,
+         100.0 * (grade1 - grade2) / grade1);
+  return sink == 0;
+}
@@ -0,0 +1,75 @@
+// Host benchmark for the deviceList/response parser: a 100 device payload parsed whole and
+// as it would arrive in 536 byte TCP segments, in microseconds per payload.
+//
+//   g++ -std=gnu++17 -O2 -Iinclude bench/device_list_bench.cpp src/DeviceList.cpp -o device_list_bench
+//   ./device_list_bench
+
+#include "DeviceList.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+static const char *const ROOMS[] = {
+  "Living Room", "Kitchen", "Main Bedroom", "Bedroom 2", "Bathroom", "Garage",
+  "Garden", "Study", "Laundry", "Dining Room"
+};
+static const char *const DEVICES[] = {
+  "Ceiling Light", "Lamp", "Smart Plug", "Air Conditioner", "Television", "Heater",
+  "Door Lock", "Curtains", "Fan", "Speaker"
+};
+
+//same shape as server.js builds it: room-dev;dev;dev,room-dev;...
+static std::string payload(int devices) {
+  std::string s;
+  for (int r = 0; r < 10; r++) {
+    if (r > 0) s += ',';
+    s += ROOMS[r];
+    s += '-';
+    for (int d = 0; d < devices / 10; d++) {
+      if (d > 0) s += ';';
+      s += DEVICES[d];
+      s += ' ';
+      s += std::to_string(r * 10 + d);
+    }
+  }
+  return s;
+}
+
+static DeviceList list;
+
+int main() {
+  const int rounds = 20000;
+  const size_t segment = 536; //default TCP MSS of lwip
+  std::string text = payload(100);
+
+  DeviceListParser parser;
+  volatile uint32_t sink = 0;
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    parser.begin(list, text.size());
+    parser.feed(text.data(), text.size());
+    parser.finish();
+    sink += list.count;
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    parser.begin(list, text.size());
+    for (size_t i = 0; i < text.size(); i += segment) {
+      parser.feed(text.data() + i, i + segment < text.size() ? segment : text.size() - i);
+    }
+    parser.finish();
+    sink += list.count;
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  double whole = std::chrono::duration<double, std::micro>(t1 - t0).count() / rounds;
+  double split = std::chrono::duration<double, std::micro>(t2 - t1).count() / rounds;
+  printf("payload: %zu bytes, %u devices in %u rooms\n", text.size(), list.count, list.rooms);
+  printf("one segment:   %.2f us\n", whole);
+  printf("%zu byte segments: %.2f us\n", segment, split);
+  printf("(%u)\n", (unsigned)sink);
+  return 0;
+}
@@ -0,0 +1,80 @@
+// Host fuzzer for the deviceList/response parser. Random payloads made of names and separators
+// are parsed whole and again split at random points; both must agree, every view must stay
+// inside the payload and never contain a separator it should have stopped at.
+//
+//   g++ -std=gnu++17 -O1 -g -fsanitize=address,undefined -Iinclude bench/device_list_fuzz.cpp src/DeviceList.cpp -o device_list_fuzz
+//   ./device_list_fuzz [iterations] [seed]
+
+#include "DeviceList.h"
+
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+static DeviceList whole;
+static DeviceList split;
+
+static bool contains(const DeviceList &list, TextView view, const char *chars) {
+  for (uint16_t i = 0; i < view.len; i++) {
+    if (strchr(chars, list.at(view)[i])) return true;
+  }
+  return false;
+}
+
+static void fail(const char *why, const std::string &text) {
+  printf("FAIL: %s\npayload (%zu bytes): %s\n", why, text.size(), text.c_str());
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  long iterations = argc > 1 ? atol(argv[1]) : 200000;
+  std::mt19937 rng(argc > 2 ? atoi(argv[2]) : 1);
+  const char alphabet[] = "ab -;,,;--E";
+
+  long accepted = 0;
+  for (long it = 0; it < iterations; it++) {
+    //mostly small payloads, now and then one near or over the buffer size
+    size_t len = rng() % 8 == 0 ? rng() % (DEVICE_LIST_BYTES + 64) : rng() % 64;
+    std::string text;
+    if (rng() % 16 == 0) text = "ERROR: ";
+    while (text.size() < len) text += alphabet[rng() % (sizeof(alphabet) - 1)];
+
+    //too big for the buffer: only the split parser sees it, it has to turn it down
+    bool fits = text.size() <= DEVICE_LIST_BYTES;
+    if (fits) memcpy(whole.text, text.data(), text.size());
+    whole.length = fits ? text.size() : 0;
+    bool okWhole = fits && parseDeviceList(whole);
+
+    DeviceListParser parser;
+    bool okSplit = parser.begin(split, text.size());
+    for (size_t i = 0; i < text.size() && okSplit;) {
+      size_t n = 1 + rng() % 40;
+      if (n > text.size() - i) n = text.size() - i;
+      okSplit = parser.feed(text.data() + i, n);
+      i += n;
+    }
+    okSplit = parser.finish() && okSplit;
+
+    if (okWhole != okSplit) fail("whole and split disagree on validity", text);
+    if (!okWhole) {
+      if ((fits && whole.count != 0) || split.count != 0) fail("rejected payload left entries", text);
+      continue;
+    }
+    accepted++;
+    if (whole.count != split.count || whole.rooms != split.rooms) fail("whole and split differ", text);
+    for (uint16_t i = 0; i < whole.count; i++) {
+      const DeviceEntry &a = whole.entry[i];
+      const DeviceEntry &b = split.entry[i];
+      if (memcmp(&a, &b, sizeof(a)) != 0) fail("entry differs", text);
+      if (a.room.offset + a.room.len > whole.length) fail("room out of bounds", text);
+      if (a.device.offset + a.device.len > whole.length) fail("device out of bounds", text);
+      if (a.device.len == 0) fail("empty device", text);
+      if (contains(whole, a.room, "-;,")) fail("separator in room", text);
+      if (contains(whole, a.device, ";,")) fail("separator in device", text);
+    }
+  }
+  printf("ok: %ld payloads, %ld accepted\n", iterations, accepted);
+  return 0;
+}
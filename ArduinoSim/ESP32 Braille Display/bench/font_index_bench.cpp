@@ -0,0 +1,91 @@
+// Host benchmark for MD_MAX72XX glyph lookup: getChar() throughput on the library's system
+// font and on a 4096 character version 2 font, nanoseconds per character for the first and
+// last characters and across the whole font. Build it twice to compare the offset index with
+// the walk it replaces; every glyph is checked against a walk of the font data first.
+//
+//   L=lib/MD_MAX72XX/src
+//   g++ -std=gnu++17 -O2 -Wno-cpp -Ihost -Iinclude -I$L -DUSE_FONT_INDEX=1 bench/font_index_bench.cpp host/Arduino.cpp host/VirtualDisplay.cpp src/BrailleLayout.cpp $L/*.cpp -o font_index_bench
+//   g++ -std=gnu++17 -O2 -Wno-cpp -Ihost -Iinclude -I$L -DUSE_FONT_INDEX=0 bench/font_index_bench.cpp host/Arduino.cpp host/VirtualDisplay.cpp src/BrailleLayout.cpp $L/*.cpp -o font_walk_bench
+//   ./font_index_bench; ./font_walk_bench
+
+#include <MD_MAX72xx.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+extern MD_MAX72XX::fontType_t _sysfont[];
+
+static MD_MAX72XX matrix(MD_MAX72XX::FC16_HW, 23, 18, 5, 4);
+
+//'F', version 2, first and last character big endian, height, then width and columns per glyph
+static std::vector<uint8_t> wideFont(uint16_t count) {
+  std::vector<uint8_t> f = {'F', 2, 0, 0, (uint8_t)((count - 1) >> 8), (uint8_t)(count - 1), 8};
+  for (uint16_t c = 0; c < count; c++) {
+    uint8_t width = 1 + c % 7;
+    f.push_back(width);
+    for (uint8_t i = 0; i < width; i++) f.push_back((uint8_t)(c + i));
+  }
+  return f;
+}
+
+//the glyph of c found the slow way, straight from the font data
+static bool sameGlyph(const uint8_t *font, uint16_t first, uint32_t dataOffset, uint16_t c) {
+  uint32_t offset = dataOffset;
+  for (uint16_t i = first; i < c; i++) offset += font[offset] + 1;
+
+  uint8_t got[16];
+  uint8_t width = matrix.getChar(c, sizeof(got), got);
+  return width == font[offset] && memcmp(got, font + offset + 1, width) == 0;
+}
+
+template <typename F>
+static double nsPer(long n, F f) {
+  auto t0 = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+static volatile uint32_t sink;
+
+static void run(const char *name, const uint8_t *font, uint16_t first, uint16_t last, uint32_t dataOffset,
+                int rounds) {
+  matrix.setFont(font);
+  for (uint32_t c = first; c <= last; c++) {
+    if (!sameGlyph(font, first, dataOffset, c)) {
+      printf("%s: character %u differs\n", name, (unsigned)c);
+      exit(1);
+    }
+  }
+
+  uint8_t buf[16];
+  long count = (long)last - first + 1;
+  double firstNs = nsPer(rounds * 64L, [&] {
+    for (long r = 0; r < rounds * 64L; r++) sink += matrix.getChar(first, sizeof(buf), buf);
+  });
+  double lastNs = nsPer(rounds * 64L, [&] {
+    for (long r = 0; r < rounds * 64L; r++) sink += matrix.getChar(last, sizeof(buf), buf);
+  });
+  double allNs = nsPer(rounds * count, [&] {
+    for (int r = 0; r < rounds; r++) {
+      for (uint32_t c = first; c <= last; c++) sink += matrix.getChar(c, sizeof(buf), buf);
+    }
+  });
+  printf("%-16s %5ld chars: first %8.1f ns, last %8.1f ns, all %8.1f ns/char\n", name, count, firstNs, lastNs,
+         allNs);
+}
+
+int main() {
+  matrix.begin();
+  printf("USE_FONT_INDEX %d, FONT_INDEX_SIZE %d\n", USE_FONT_INDEX, FONT_INDEX_SIZE);
+
+  run("system font", _sysfont, 0, 255, 7, 2000);
+
+  std::vector<uint8_t> wide = wideFont(4096);
+  run("v2 4096 chars", wide.data(), 0, 4095, 7, 4);
+
+  printf("(%u)\n", (unsigned)sink);
+  return 0;
+}
@@ -0,0 +1,171 @@
+// Host benchmark for the device list formats: the same 100 devices as the binary snapshot
+// (WireFormat.h), the text payload and the JSON the web app's API returns, size on the wire and
+// microseconds to parse each into something the menu can use. Binary and JSON carry each device's
+// status and battery, which the text payload has no room for. JSON is parsed with ArduinoJson
+// when it is on the include path (e.g. -I.pio/libdeps/<env>/ArduinoJson/src), without it only
+// its size is shown.
+//
+//   g++ -std=gnu++17 -O2 -Iinclude bench/wire_format_bench.cpp src/DeviceList.cpp -o wire_format_bench
+//   ./wire_format_bench
+
+#include "DeviceList.h"
+#include "WireFormat.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#if __has_include(<ArduinoJson.h>)
+#include <ArduinoJson.h>
+#define HAVE_ARDUINOJSON 1
+#endif
+
+static const char *const ROOMS[] = {
+  "Living Room", "Kitchen", "Main Bedroom", "Bedroom 2", "Bathroom", "Garage",
+  "Garden", "Study", "Laundry", "Dining Room"
+};
+static const char *const DEVICES[] = {
+  "Ceiling Light", "Lamp", "Smart Plug", "Air Conditioner", "Television", "Heater",
+  "Door Lock", "Curtains", "Fan", "Speaker"
+};
+
+struct Device {
+  int room;
+  std::string name;
+  uint8_t status;
+  uint8_t battery;
+};
+
+static std::vector<Device> devices(int count) {
+  std::vector<Device> v;
+  for (int r = 0; r < 10; r++) {
+    for (int d = 0; d < count / 10; d++) {
+      uint8_t battery = d % 3 == 0 ? (uint8_t)(40 + r * 5) : STATUS_UNKNOWN;
+      v.push_back({r, std::string(DEVICES[d]) + " " + std::to_string(r * 10 + d), (uint8_t)(d & 1), battery});
+    }
+  }
+  return v;
+}
+
+//same as services/wireFormat.js encodeSnapshot()
+static std::string binary(const std::vector<Device> &v) {
+  std::string s = {(char)WIRE_MAGIC0, (char)WIRE_MAGIC1, (char)WIRE_FORMAT, (char)WIRE_SNAPSHOT};
+  auto u16 = [&](uint16_t x) { s += (char)x; s += (char)(x >> 8); };
+  auto u32 = [&](uint32_t x) { u16(x); u16(x >> 16); };
+  u32(1700000000);
+  u32(42);
+  u32(0);
+  u16(10);
+  u16(v.size());
+  for (int r = 0; r < 10; r++) {
+    s += (char)strlen(ROOMS[r]);
+    s += ROOMS[r];
+    s += (char)(v.size() / 10);
+    for (const Device &d : v) {
+      if (d.room != r) continue;
+      s += (char)d.status;
+      s += (char)d.battery;
+      s += (char)d.name.size();
+      s += d.name;
+    }
+  }
+  return s;
+}
+
+//same as server.js builds it: room-dev;dev;dev,room-dev;...
+static std::string text(const std::vector<Device> &v) {
+  std::string s;
+  for (size_t i = 0; i < v.size(); i++) {
+    bool newRoom = i == 0 || v[i].room != v[i - 1].room;
+    if (newRoom && i > 0) s += ',';
+    if (newRoom) s += std::string(ROOMS[v[i].room]) + "-";
+    else s += ';';
+    s += v[i].name;
+  }
+  return s;
+}
+
+//the shape of the web app's GET /api/devices, with the status a device publishes
+static std::string json(const std::vector<Device> &v) {
+  std::string s = "{\"rooms\":[";
+  for (size_t i = 0; i < v.size(); i++) {
+    bool newRoom = i == 0 || v[i].room != v[i - 1].room;
+    if (newRoom && i > 0) s += "]},";
+    if (newRoom) s += std::string("{\"roomName\":\"") + ROOMS[v[i].room] + "\",\"devices\":[";
+    else s += ',';
+    s += "{\"deviceName\":\"" + v[i].name + "\",\"status\":\"" + (v[i].status ? "ON" : "OFF") + "\"";
+    if (v[i].battery != STATUS_UNKNOWN) s += ",\"battery\":" + std::to_string(v[i].battery);
+    s += '}';
+  }
+  return s + "]}]}";
+}
+
+static DeviceList list;
+
+template <typename F>
+static double usPer(int rounds, F f) {
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) f();
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / rounds;
+}
+
+static bool load(const std::string &payload) {
+  memcpy(list.text, payload.data(), payload.size());
+  list.length = payload.size();
+  return parseDeviceList(list);
+}
+
+int main() {
+  const int rounds = 20000;
+  std::vector<Device> v = devices(100);
+  std::string bin = binary(v), txt = text(v), js = json(v);
+  volatile uint32_t sink = 0;
+
+  //both have to give the same names before their times mean anything
+  if (!load(bin) || list.count != v.size() || list.rooms != 10) {
+    printf("binary snapshot didn't decode\n");
+    return 1;
+  }
+  for (size_t i = 0; i < v.size(); i++) {
+    const DeviceEntry &e = list.entry[i];
+    if (std::string(list.at(e.device), e.device.len) != v[i].name ||
+        std::string(list.at(e.room), e.room.len) != ROOMS[v[i].room] || e.status != v[i].status ||
+        e.battery != v[i].battery) {
+      printf("binary entry %zu differs\n", i);
+      return 1;
+    }
+  }
+  if (!load(txt) || list.count != v.size()) {
+    printf("text payload didn't parse\n");
+    return 1;
+  }
+
+  double binUs = usPer(rounds, [&] { load(bin); sink += list.count; });
+  double txtUs = usPer(rounds, [&] { load(txt); sink += list.count; });
+
+  printf("%zu devices in 10 rooms\n", v.size());
+  printf("binary: %5zu bytes, %.2f us\n", bin.size(), binUs);
+  printf("text:   %5zu bytes, %.2f us\n", txt.size(), txtUs);
+#ifdef HAVE_ARDUINOJSON
+#if ARDUINOJSON_VERSION_MAJOR >= 7
+  JsonDocument doc;
+#else
+  DynamicJsonDocument doc(16384);
+#endif
+  double jsUs = usPer(rounds, [&] {
+    if (deserializeJson(doc, js.data(), js.size())) return;
+    for (JsonObject room : doc["rooms"].as<JsonArray>()) {
+      for (JsonObject device : room["devices"].as<JsonArray>()) {
+        sink += strlen(device["deviceName"] | "") + (device["battery"] | 0);
+      }
+    }
+  });
+  printf("json:   %5zu bytes, %.2f us (ArduinoJson %s)\n", js.size(), jsUs, ARDUINOJSON_VERSION);
+#else
+  printf("json:   %5zu bytes, not parsed (ArduinoJson not on the include path)\n", js.size());
+#endif
+  printf("(%u)\n", (unsigned)sink);
+  return 0;
+}
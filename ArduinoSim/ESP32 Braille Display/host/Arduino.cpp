@@ -0,0 +1,67 @@
+#include <Arduino.h>
+#include <SPI.h>
+#include <chrono>
+#include <thread>
+#include "VirtualDisplay.h"
+
+HardwareSerial Serial;
+SPIClass SPI;
+
+static uint8_t pinLevel[64];
+static const auto startTime = std::chrono::steady_clock::now();
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  if (pin < sizeof(pinLevel)) pinLevel[pin] = level;
+  if (VirtualDisplay::active) VirtualDisplay::active->pinWritten(pin, level);
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < sizeof(pinLevel) ? pinLevel[pin] : LOW;
+}
+
+void shiftOut(uint8_t, uint8_t, uint8_t, uint8_t value) {
+  if (VirtualDisplay::active) VirtualDisplay::active->byteShifted(value);
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+  if (VirtualDisplay::active) VirtualDisplay::active->byteShifted(data);
+  return 0;
+}
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (n < size && write(buffer[n])) n++;
+  return n;
+}
+
+int Print::printf(const char *format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (len > 0) write((const uint8_t *)buf, (size_t)len < sizeof(buf) ? len : sizeof(buf) - 1);
+  return len;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+//Just enough of the Arduino core for the braille pipeline and the real MD_MAX72XX library to
+//build on a PC ([env:native]). Pin writes, shiftOut() and SPI.transfer() go to the VirtualDisplay.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define PROGMEM
+#define IRAM_ATTR
+#define F(s) s
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLDOWN 2
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t value);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t println(const char *s) { return print(s) + print("\n"); }
+  int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+//stdout
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+};
+
+extern HardwareSerial Serial;
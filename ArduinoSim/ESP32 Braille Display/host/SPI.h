@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0
+
+struct SPISettings {
+  SPISettings(uint32_t clock, uint8_t, uint8_t) : clock(clock) {}
+  uint32_t clock;
+};
+
+//hardware SPI on the host: every byte goes to the VirtualDisplay, same as shiftOut()
+class SPIClass {
+public:
+  void begin() {}
+  void end() {}
+  void beginTransaction(SPISettings) {}
+  uint8_t transfer(uint8_t data);
+  void endTransaction() {}
+};
+
+extern SPIClass SPI;
@@ -0,0 +1,131 @@
+#include "VirtualDisplay.h"
+
+//MAX7219 register addresses
+enum : uint8_t {
+  REG_NOOP = 0x00,
+  REG_DIGIT0 = 0x01,
+  REG_DIGIT7 = 0x08,
+  REG_INTENSITY = 0x0A,
+  REG_SHUTDOWN = 0x0C
+};
+
+VirtualDisplay *VirtualDisplay::active = nullptr;
+
+VirtualDisplay::VirtualDisplay(const LineGeometry &geometry, uint8_t csPin)
+    : _geometry(geometry), _devices(geometry.devices < MAX_DEVICES ? geometry.devices : MAX_DEVICES),
+      _csPin(csPin) {
+  for (uint8_t dev = 0; dev < MAX_DEVICES; dev++) {
+    _shutdown[dev] = true; //how a MAX7219 powers up
+  }
+  active = this;
+}
+
+VirtualDisplay::~VirtualDisplay() {
+  if (active == this) active = nullptr;
+}
+
+void VirtualDisplay::pinWritten(uint8_t pin, uint8_t level) {
+  if (pin != _csPin) return;
+  if (level == LOW && !_selected) {
+    _selected = true;
+    _shift.clear();
+  } else if (level == HIGH && _selected) {
+    _selected = false;
+    latch();
+  }
+}
+
+void VirtualDisplay::byteShifted(uint8_t value) {
+  _bytes++;
+  if (_selected) _shift.push_back(value);
+}
+
+//The chain is one long shift register: the last two bytes in end up in device 0 (the one
+//nearest the ESP32), the two before that in device 1 and so on.
+void VirtualDisplay::latch() {
+  _frames.push_back(_shift);
+  size_t n = _shift.size();
+  for (uint8_t dev = 0; dev < _devices && 2u * (dev + 1) <= n; dev++) {
+    uint8_t reg = _shift[n - 2 * (dev + 1)];
+    uint8_t data = _shift[n - 2 * (dev + 1) + 1];
+    if (reg >= REG_DIGIT0 && reg <= REG_DIGIT7) {
+      _digit[dev][reg - REG_DIGIT0] = data;
+    } else if (reg == REG_INTENSITY) {
+      _intensity[dev] = data & 0x0F;
+    } else if (reg == REG_SHUTDOWN) {
+      _shutdown[dev] = (data & 0x01) == 0;
+    }
+  }
+}
+
+void VirtualDisplay::resetCounters() {
+  _frames.clear();
+  _bytes = 0;
+}
+
+void VirtualDisplay::readCells(uint8_t cells[]) const {
+  for (uint8_t i = 0; i < _geometry.cells; i++) {
+    cells[i] = 0;
+    for (uint8_t d = 0; d < 8; d++) {
+      const DotTarget &t = _geometry.cell[i].dot[d];
+      if (_digit[t.device][t.digit] & t.mask) cells[i] |= 1 << d;
+    }
+  }
+}
+
+std::string VirtualDisplay::cellText() const {
+  uint8_t cells[MAX_LINE_CELLS];
+  readCells(cells);
+  std::string s;
+  for (uint8_t i = 0; i < _geometry.cells; i++) {
+    uint16_t cp = 0x2800 + cells[i];
+    s += (char)(0xE0 | (cp >> 12));
+    s += (char)(0x80 | ((cp >> 6) & 0x3F));
+    s += (char)(0x80 | (cp & 0x3F));
+  }
+  return s;
+}
+
+std::string VirtualDisplay::matrixText() const {
+  std::string s;
+  for (uint8_t row = 0; row < 8; row++) {
+    for (int col = _devices * 8 - 1; col >= 0; col--) {
+      s += _digit[col / 8][row] & (1 << (col % 8)) ? '#' : '.';
+      if (col % 8 == 0 && col > 0) s += ' ';
+    }
+    s += '\n';
+  }
+  return s;
+}
+
+bool VirtualDisplay::writePpm(const char *path, uint8_t scale) const {
+  FILE *f = fopen(path, "wb");
+  if (f == nullptr) return false;
+
+  const int gap = scale; //dark strip between modules
+  int width = _devices * 8 * scale + (_devices - 1) * gap;
+  int height = 8 * scale;
+  fprintf(f, "P6\n%d %d\n255\n", width, height);
+
+  for (int y = 0; y < height; y++) {
+    int row = y / scale;
+    for (int x = 0; x < width; x++) {
+      int module = x / (8 * scale + gap);
+      int inModule = x % (8 * scale + gap);
+      uint8_t rgb[3] = {0, 0, 0};
+      if (inModule < 8 * scale) {
+        int col = (_devices - 1 - module) * 8 + 7 - inModule / scale;
+        bool on = !_shutdown[col / 8] && (_digit[col / 8][row] & (1 << (col % 8)));
+        //cyan like the wokwi matrix, dim grey when off
+        if (on) {
+          rgb[1] = 255;
+          rgb[2] = 255;
+        } else {
+          rgb[0] = rgb[1] = rgb[2] = 40;
+        }
+      }
+      fwrite(rgb, 1, 3, f);
+    }
+  }
+  return fclose(f) == 0;
+}
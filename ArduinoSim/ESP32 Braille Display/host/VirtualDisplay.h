@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include "BrailleLayout.h"
+
+//A chain of MAX7219s on the host. It sits where the SPI wires would be: bytes clocked out while
+//CS is low make up one frame, and at the rising edge of CS each device latches its 16 bit word.
+//Every frame is kept so tests can look at exactly what went over the bus. The chain is as long
+//as the panel's geometry says, and the braille line is read back through its map.
+class VirtualDisplay {
+public:
+  static constexpr uint8_t MAX_DEVICES = MAX_LINE_DEVICES;
+
+  VirtualDisplay(const LineGeometry &geometry, uint8_t csPin);
+  ~VirtualDisplay();
+
+  //called by the Arduino shim
+  void pinWritten(uint8_t pin, uint8_t level);
+  void byteShifted(uint8_t value);
+
+  //frames and bytes since the last resetCounters()
+  const std::vector<std::vector<uint8_t>> &frames() const { return _frames; }
+  uint32_t transactions() const { return _frames.size(); }
+  uint32_t bytes() const { return _bytes; }
+  void resetCounters();
+
+  //digit register (= matrix row on FC16) of a device, as latched
+  uint8_t digit(uint8_t device, uint8_t row) const { return _digit[device][row]; }
+  bool shutdown(uint8_t device) const { return _shutdown[device]; }
+  uint8_t intensity(uint8_t device) const { return _intensity[device]; }
+
+  //the braille line read back, geometry().cells cells, one per byte like the rest of the code
+  void readCells(uint8_t cells[]) const;
+  const LineGeometry &geometry() const { return _geometry; }
+  //the same cells as unicode braille (U+2800 block), UTF-8
+  std::string cellText() const;
+  //the LEDs, '#' on and '.' off, column 63 on the left like MD_MAX72XX numbers them
+  std::string matrixText() const;
+  //binary PPM of the LEDs, scale pixels per LED
+  bool writePpm(const char *path, uint8_t scale = 8) const;
+
+  static VirtualDisplay *active; //where the shim sends pin writes and bytes
+
+private:
+  void latch();
+
+  const LineGeometry &_geometry;
+  uint8_t _devices;
+  uint8_t _csPin;
+  bool _selected = false;
+  std::vector<uint8_t> _shift; //bytes of the frame being clocked in
+  std::vector<std::vector<uint8_t>> _frames;
+  uint32_t _bytes = 0;
+
+  uint8_t _digit[MAX_DEVICES][8] = {};
+  uint8_t _intensity[MAX_DEVICES] = {};
+  bool _shutdown[MAX_DEVICES] = {};
+};
@@ -0,0 +1,328 @@
+// Host build of the braille pipeline ([env:native] in platformio.ini): translation, the line
+// buffer, the menu and the real MD_MAX72XX library, which drives a VirtualDisplay instead of
+// the SPI wires.
+//
+//   pio run -e native
+//   .pio/build/native/program render [ppm dir]       every demo menu line as braille and LEDs
+//   .pio/build/native/program bench                  render time and SPI traffic per line and blink step
+//   .pio/build/native/program golden host/golden [update]
+//                                                    compare lines with the stored frames
+//   .pio/build/native/program panels                 every known panel size, drawn and timed
+//
+// Every line drawn is read back from the virtual LEDs and checked against the cells that were
+// meant to be shown; any difference exits with status 1.
+
+#include <MD_MAX72xx.h>
+#include <chrono>
+#include <string>
+#include "BrailleLayout.h"
+#include "BrailleLine.h"
+#include "DeviceList.h"
+#include "LineRenderer.h"
+#include "Menu.h"
+#include "VirtualDisplay.h"
+
+//same wiring as the firmware
+#define HARDWARE_TYPE MD_MAX72XX::FC16_HW
+#define CLK_PIN 18
+#define DATA_PIN 23
+#define CS_PIN 21
+
+//the firmware's offline menu
+static const char DEMO_DEVICES[] = "bathroom-lights,kitchen-lights;thermostats,bedroom-lights;doorlocks";
+
+struct GoldenCase {
+  const char *name;
+  const char *text;
+  uint8_t table;
+};
+
+static const GoldenCase GOLDEN[] = {
+  {"bathroom", "bathroom", TABLE_UEB_GRADE2},
+  {"kitchen", "Kitchen: Lights, Thermostats.", TABLE_UEB_GRADE2},
+  {"unlocked_grade1", "unlocked", TABLE_GRADE1},
+  {"numbers", "Room 12, 3.5 kW", TABLE_UEB_GRADE2},
+  {"numbers_computer", "Room 12, 3.5 kW", TABLE_COMPUTER},
+  {"quote", "\"on\" - off", TABLE_GRADE1},
+  {"blank", "", TABLE_UEB_GRADE2}
+};
+
+//the goldens and the menu are drawn on the prototype
+static const LineGeometry &geometry = PANELS[0];
+static VirtualDisplay display(geometry, CS_PIN);
+static MD_MAX72XX matrix(HARDWARE_TYPE, DATA_PIN, CLK_PIN, CS_PIN, geometry.devices);
+static LineRenderer renderer(matrix, geometry);
+static BrailleLine line(geometry.cells);
+static DeviceList list;
+static Menu menu;
+
+//makes sure the LEDs show exactly the visible part of line
+static bool shows(const VirtualDisplay &display, const BrailleLine &line) {
+  uint8_t shown[MAX_LINE_CELLS];
+  display.readCells(shown);
+  for (uint8_t i = 0; i < display.geometry().cells; i++) {
+    uint8_t expected = i < line.visibleCount() ? line.visible()[i] : 0;
+    if (shown[i] != expected) {
+      printf("cell %u shows %02x, expected %02x\n", i + 1, shown[i], expected);
+      return false;
+    }
+  }
+  return true;
+}
+
+//draws the visible part of line on the prototype and checks it
+static bool drawLine() {
+  renderer.commit(line.visible(), line.visibleCount());
+  return shows(display, line);
+}
+
+static void loadDemoMenu() {
+  strcpy(list.text, DEMO_DEVICES);
+  list.length = strlen(DEMO_DEVICES);
+  parseDeviceList(list);
+  menu.build(list, TABLE_UEB_GRADE2);
+}
+
+//every room and device of the demo menu in node order (node 0 is the root)
+template <typename F>
+static bool forEachItem(F f) {
+  for (uint16_t i = 1; i < MENU_NODES; i++) {
+    if (!menu.select(i)) break;
+    if (menu.current().kind == MENU_ACTION) continue;
+    if (!f(menu.current())) return false;
+  }
+  return true;
+}
+
+static int render(const char *ppmDir) {
+  loadDemoMenu();
+  int frame = 0;
+  bool ok = forEachItem([&](const MenuNode &node) {
+    line.showCells(menu.cells(node), node.length);
+    do {
+      if (!drawLine()) return false;
+      printf("%s\n%s\n", display.cellText().c_str(), display.matrixText().c_str());
+      if (ppmDir != nullptr) {
+        std::string path = std::string(ppmDir) + "/frame" + std::to_string(frame) + ".ppm";
+        display.writePpm(path.c_str());
+      }
+      frame++;
+    } while (line.panRight());
+    return true;
+  });
+  return ok ? 0 : 1;
+}
+
+struct SpiStats {
+  uint32_t lines = 0;
+  uint64_t bytes = 0;
+  uint64_t transactions = 0;
+  uint32_t maxBytes = 0;
+  double seconds = 0;
+
+  //on whichever display the shim is driving
+  template <typename F>
+  void measure(F draw) {
+    VirtualDisplay &on = *VirtualDisplay::active;
+    on.resetCounters();
+    auto t0 = std::chrono::steady_clock::now();
+    draw();
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    lines++;
+    bytes += on.bytes();
+    transactions += on.transactions();
+    if (on.bytes() > maxBytes) maxBytes = on.bytes();
+  }
+
+  void print(const char *name) const {
+    printf("%s: %u lines, %.3f us/line, spi %.1f bytes/line (max %u), %.2f transactions/line\n", name,
+           lines, seconds * 1e6 / lines, (double)bytes / lines, maxBytes, (double)transactions / lines);
+  }
+};
+
+//Blinks the cursor over the text on display rounds times, checking the LEDs; the overlay is
+//cleared again afterwards.
+static bool blinkCursor(const VirtualDisplay &display, LineRenderer &draw, BrailleLine &text, int rounds,
+                        SpiStats &blink) {
+  static const char TEXT[] = "heater: on";
+  const uint16_t periodMs = 500;
+  text.setText(TEXT, strlen(TEXT), TABLE_UEB_GRADE2);
+  draw.commit(text.visible(), text.visibleCount());
+  draw.setOverlay(0, CURSOR_DOTS, periodMs);
+  for (int r = 0; r < rounds; r++) {
+    blink.measure([&] { draw.refresh(r * periodMs); });
+    uint8_t shown[MAX_LINE_CELLS];
+    display.readCells(shown);
+    uint8_t expected = text.visible()[0] | (r % 2 == 0 ? CURSOR_DOTS : 0);
+    if (shown[0] != expected) {
+      printf("cursor cell shows %02x, expected %02x\n", shown[0], expected);
+      return false;
+    }
+  }
+  draw.clearOverlay();
+  draw.refresh(0);
+  return shows(display, text);
+}
+
+//render time is on the host and includes the virtual SPI; the spi numbers are what the panel gets
+static int bench() {
+  loadDemoMenu();
+  const int rounds = 2000;
+  SpiStats full, diff, toggle;
+
+  //walking the menu, every line drawn in full (blitCells) and by difference (LineRenderer)
+  for (int r = 0; r < rounds; r++) {
+    bool ok = forEachItem([&](const MenuNode &node) {
+      line.showCells(menu.cells(node), node.length);
+      full.measure([] { blitCells(matrix, geometry, line.visible(), line.visibleCount()); });
+      renderer.invalidate();
+      return r > 0 || drawLine(); //check every line once
+    });
+    if (!ok) return 1;
+  }
+  for (int r = 0; r < rounds; r++) {
+    bool ok = forEachItem([&](const MenuNode &node) {
+      line.showCells(menu.cells(node), node.length);
+      diff.measure([] { renderer.commit(line.visible(), line.visibleCount()); });
+      return r > 0 || drawLine();
+    });
+    if (!ok) return 1;
+  }
+
+  //a status word changing on a steady line
+  const char *status[] = {"heater: on", "heater: off"};
+  for (int r = 0; r < rounds; r++) {
+    line.setText(status[r & 1], strlen(status[r & 1]), TABLE_UEB_GRADE2);
+    toggle.measure([] { renderer.commit(line.visible(), line.visibleCount()); });
+    if (r < 2 && !drawLine()) return 1;
+  }
+
+  //the cursor blinking under the first cell of a steady line, every refresh a phase change
+  SpiStats blink;
+  if (!blinkCursor(display, renderer, line, rounds, blink)) return 1;
+
+  full.print("menu, full repaint  ");
+  diff.print("menu, diff          ");
+  toggle.print("status toggle, diff ");
+  blink.print("cursor blink        ");
+  printf("cells rewritten: %u in %u commits\n", renderer.cellsRewritten(), renderer.commits());
+
+  //device states with capitals and numbers, how much line each table needs for them
+  static const char *const STATES[] = {"Heater 2: ON, 21.5C", "Kitchen Lights: OFF", "AC Unit 3: ON, 18C",
+                                       "Door Lock: LOCKED, 87%", "TV 2: OFF", "Bedroom 2 Fan: ON, Speed 3"};
+  static const char *const TABLE_NAMES[TABLE_COUNT] = {"grade 1", "grade 2", "computer"};
+  for (uint8_t t = 0; t < TABLE_COUNT; t++) {
+    unsigned cells = 0, windows = 0;
+    for (const char *state : STATES) {
+      line.setText(state, strlen(state), t);
+      cells += line.length();
+      do {
+        if (!drawLine()) return 1;
+        windows++;
+      } while (line.panRight());
+    }
+    printf("device states, %-9s %3u cells, %2u windows of %u\n", TABLE_NAMES[t], cells, windows, geometry.cells);
+  }
+  return 0;
+}
+
+static std::string goldenFrames(const GoldenCase &c) {
+  std::string s;
+  line.setText(c.text, strlen(c.text), c.table);
+  int window = 0;
+  do {
+    if (!drawLine()) return "";
+    s += "window " + std::to_string(window++) + "\n" + display.cellText() + "\n" + display.matrixText();
+  } while (line.panRight());
+  return s;
+}
+
+static int golden(const char *dir, bool update) {
+  int failed = 0;
+  for (const GoldenCase &c : GOLDEN) {
+    std::string frames = goldenFrames(c);
+    if (frames.empty()) return 1;
+    std::string path = std::string(dir) + "/" + c.name + ".txt";
+
+    if (update) {
+      FILE *f = fopen(path.c_str(), "wb");
+      if (f == nullptr || fwrite(frames.data(), 1, frames.size(), f) != frames.size()) return 1;
+      fclose(f);
+      printf("wrote %s\n", path.c_str());
+      continue;
+    }
+
+    std::string stored;
+    FILE *f = fopen(path.c_str(), "rb");
+    if (f != nullptr) {
+      char buf[512];
+      size_t n;
+      while ((n = fread(buf, 1, sizeof(buf), f)) > 0) stored.append(buf, n);
+      fclose(f);
+    }
+    bool same = f != nullptr && stored == frames;
+    printf("%-16s %s\n", c.name, same ? "ok" : "DIFFERENT");
+    if (!same) {
+      printf("got:\n%s", frames.c_str());
+      failed++;
+    }
+  }
+  return failed ? 1 : 0;
+}
+
+//Each panel on a chain of its own length: a long text panned through, every window checked, and
+//what a full repaint and a one word change cost on it.
+static int panels() {
+  static const char TEXT[] = "The kitchen lights are on, the heater is off and the front door is locked. "
+                             "Bedroom 2: fan, lamp and curtains.";
+  for (uint8_t p = 0; p < PANEL_COUNT; p++) {
+    const LineGeometry &g = PANELS[p];
+    VirtualDisplay panel(g, CS_PIN);
+    MD_MAX72XX chain(HARDWARE_TYPE, DATA_PIN, CLK_PIN, CS_PIN, g.devices);
+    LineRenderer draw(chain, g);
+    BrailleLine text(g.cells);
+    chain.begin();
+    chain.clear();
+
+    const int rounds = 2000;
+    SpiStats full, toggle;
+    text.setText(TEXT, strlen(TEXT), TABLE_UEB_GRADE2);
+    for (int r = 0; r < rounds; r++) {
+      draw.invalidate();
+      full.measure([&] { draw.commit(text.visible(), text.visibleCount()); });
+      if (!shows(panel, text)) return 1;
+      if (!text.panRight()) text.home();
+    }
+
+    const char *status[] = {"heater: on", "heater: off"};
+    for (int r = 0; r < rounds; r++) {
+      text.setText(status[r & 1], strlen(status[r & 1]), TABLE_UEB_GRADE2);
+      toggle.measure([&] { draw.commit(text.visible(), text.visibleCount()); });
+      if (r < 2 && !shows(panel, text)) return 1;
+    }
+
+    SpiStats blink;
+    if (!blinkCursor(panel, draw, text, rounds, blink)) return 1;
+
+    printf("%-5s %2u cells on %2u modules\n", g.name, g.cells, g.devices);
+    full.print("  full repaint       ");
+    toggle.print("  status toggle, diff");
+    blink.print("  cursor blink       ");
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  matrix.begin();
+  matrix.control(MD_MAX72XX::INTENSITY, 5);
+  matrix.clear();
+
+  std::string command = argc > 1 ? argv[1] : "render";
+  if (command == "render") return render(argc > 2 ? argv[2] : nullptr);
+  if (command == "bench") return bench();
+  if (command == "panels") return panels();
+  if (command == "golden" && argc > 2) return golden(argv[2], argc > 3 && std::string(argv[3]) == "update");
+
+  printf("usage: %s render [ppm dir] | bench | golden <dir> [update] | panels\n", argv[0]);
+  return 2;
+}
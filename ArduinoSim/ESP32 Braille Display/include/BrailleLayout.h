@@ -0,0 +1,99 @@
+#pragma once
+
+#include <MD_MAX72xx.h>
+#include <stdint.h>
+
+//where a single dot lives in the MAX7219 chain. On FC16 modules the digit
+//registers are the matrix rows, so digit is the display row and mask the column bit.
+struct DotTarget {
+  uint8_t device;
+  uint8_t digit;
+  uint8_t mask;
+};
+
+//dots 1-8 of one cell, in the same order as the bits of a cell
+struct CellLayout {
+  DotTarget dot[8];
+};
+
+//the biggest unit we build, the cell-to-digit map and per frame buffers are sized for it
+constexpr uint8_t MAX_LINE_CELLS = 40;
+constexpr uint8_t MAX_LINE_DEVICES = 32;
+
+constexpr DotTarget dotAt(uint16_t col, uint8_t row) {
+  //a row below the matrix has no LED, mask 0 keeps the dot from ever being drawn
+  return {(uint8_t)(col / COL_SIZE), (uint8_t)(row < ROW_SIZE ? row : 0),
+          (uint8_t)(row < ROW_SIZE ? 1 << (col % COL_SIZE) : 0)};
+}
+
+//dots 1-3 go down the left column, 4-6 down the right one, rowPitch rows apart from row on, and
+//7 and 8 one more row down (row 7 with the defaults). Where that row is off the matrix the cell
+//only has 6 dots.
+constexpr CellLayout cellAt(uint16_t leftCol, uint16_t rightCol, uint8_t row = 1, uint8_t rowPitch = 2) {
+  return CellLayout{{
+    dotAt(leftCol, row),
+    dotAt(leftCol, row + rowPitch),
+    dotAt(leftCol, row + 2 * rowPitch),
+    dotAt(rightCol, row),
+    dotAt(rightCol, row + rowPitch),
+    dotAt(rightCol, row + 2 * rowPitch),
+    dotAt(leftCol, row + 3 * rowPitch),
+    dotAt(rightCol, row + 3 * rowPitch)
+  }};
+}
+
+//How a panel is built: evenly spaced cells on a chain of modules, one row of modules per line.
+//Columns count along the chain from 0, the first column of the module nearest the ESP32.
+struct PanelGeometry {
+  uint8_t cells;     //per line
+  uint8_t lines;     //each line is a row of modules further down the chain
+  uint8_t cellPitch; //columns from one cell's dot 1 to the next cell's
+  uint8_t dotPitch;  //columns from dot 1 to dot 4, and rows from dot 1 to dot 2
+  uint8_t firstRow;  //row of dot 1
+  bool reversed;     //cell 1 is at the far end of its line's modules
+};
+
+//The cell-to-digit map of a panel, cell 1 first; on a panel with more lines the next line's cells
+//follow, so the window shown is all of them. Everything that draws or reads the line goes by it.
+struct LineGeometry {
+  const char *name;
+  uint8_t cells;   //on all lines together
+  uint8_t devices; //modules in the chain
+  CellLayout cell[MAX_LINE_CELLS];
+};
+
+constexpr uint8_t devicesPerLine(const PanelGeometry &panel) {
+  return ((panel.cells - 1) * panel.cellPitch + panel.dotPitch + COL_SIZE) / COL_SIZE;
+}
+
+//false if the panel needs more cells or modules than we have room for, or a cell doesn't fit
+constexpr bool panelFits(const PanelGeometry &panel) {
+  return panel.cells > 0 && panel.lines > 0 && panel.dotPitch > 0 &&
+         panel.cellPitch > panel.dotPitch && panel.cells * panel.lines <= MAX_LINE_CELLS &&
+         devicesPerLine(panel) * panel.lines <= MAX_LINE_DEVICES &&
+         panel.firstRow + 2 * panel.dotPitch < ROW_SIZE;
+}
+
+//Works the map out from the panel, at compile time for the panels below or at run time for one
+//described in a file. Check panelFits() first.
+constexpr LineGeometry makeGeometry(const char *name, const PanelGeometry &panel) {
+  uint8_t perLine = devicesPerLine(panel);
+  LineGeometry g = {name, (uint8_t)(panel.cells * panel.lines), (uint8_t)(perLine * panel.lines), {}};
+  for (uint8_t i = 0; i < g.cells; i++) {
+    uint16_t lineStart = i / panel.cells * perLine * COL_SIZE;
+    uint16_t left = i % panel.cells * panel.cellPitch;
+    if (panel.reversed) left = perLine * COL_SIZE - 1 - panel.dotPitch - left;
+    g.cell[i] = cellAt(lineStart + left, lineStart + left + panel.dotPitch, panel.firstRow, panel.dotPitch);
+  }
+  return g;
+}
+
+//the panels this firmware knows by name, the 13 cell prototype first
+extern const LineGeometry PANELS[];
+extern const uint8_t PANEL_COUNT;
+//by name, nullptr if there is none
+const LineGeometry *findPanel(const char *name);
+
+//draws count cells (the rest of the line is blanked) into the matrix buffer a whole
+//digit byte at a time and sends the frame with one flush, one SPI transaction per changed digit
+void blitCells(MD_MAX72XX &matrix, const LineGeometry &geometry, const uint8_t cells[], uint8_t count);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+constexpr uint16_t LINE_BUFFER_CELLS = 512;
+
+//A whole message translated once into a strip of cells, with a window of the
+//display's width over it. Panning only moves the window, the text is never re-translated.
+class BrailleLine {
+public:
+  explicit BrailleLine(uint8_t width) : _width(width) {}
+
+  //translate text with a TranslationTable into the strip and go back to its start. Text that
+  //doesn't fit in LINE_BUFFER_CELLS is cut off.
+  void setText(const char *text, size_t len, uint8_t table);
+  //show cells that are already translated, without copying them; they have to stay put while shown
+  void showCells(const uint8_t *cells, uint16_t count);
+
+  const uint8_t *visible() const { return _strip + _offset; }
+  uint8_t visibleCount() const;
+
+  uint16_t length() const { return _length; }
+  uint16_t offset() const { return _offset; }
+  uint8_t width() const { return _width; }
+  //for a panel of another size, back to the start of the strip
+  void setWidth(uint8_t width) {
+    _width = width;
+    _offset = 0;
+  }
+
+  //move by a whole display width, false if already at that end
+  bool panRight();
+  bool panLeft();
+  //back to the start, false if already there
+  bool home();
+
+  //move so the next / previous word starts the window, false if there isn't one
+  bool nextWord();
+  bool prevWord();
+
+private:
+  bool wordStart(uint16_t i) const { return _strip[i] != 0 && (i == 0 || _strip[i - 1] == 0); }
+
+  uint8_t _cells[LINE_BUFFER_CELLS];
+  const uint8_t *_strip = _cells; //_cells, or the caller's cells after showCells()
+  uint16_t _length = 0;
+  uint16_t _offset = 0;
+  uint8_t _width;
+};
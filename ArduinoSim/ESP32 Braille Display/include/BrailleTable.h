@@ -0,0 +1,145 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+//one bit per dot, dot 1 in bit 0 (same order as the unicode braille block, U+2800 + cell)
+constexpr uint8_t DOT1 = 0x01;
+constexpr uint8_t DOT2 = 0x02;
+constexpr uint8_t DOT3 = 0x04;
+constexpr uint8_t DOT4 = 0x08;
+constexpr uint8_t DOT5 = 0x10;
+constexpr uint8_t DOT6 = 0x20;
+constexpr uint8_t DOT7 = 0x40;
+constexpr uint8_t DOT8 = 0x80;
+
+constexpr uint8_t SIX_DOT_MASK = 0x3F;
+constexpr uint8_t CURSOR_DOTS = DOT7 | DOT8; //under the cursor's cell, like a computer braille display
+constexpr uint8_t STATUS_ON_DOTS = DOT8;     //steady under a device's first cell while it reports on
+
+//how text is turned into cells
+enum TranslationTable : uint8_t {
+  TABLE_GRADE1,     //translateText()
+  TABLE_UEB_GRADE2, //translateContracted() with UEB_CONTRACTIONS
+  TABLE_COMPUTER,   //translateComputer(), 8 dots
+  TABLE_COUNT
+};
+
+//UEB indicator cells
+constexpr uint8_t CAPITAL_SIGN = DOT6;                   //next letter is a capital
+constexpr uint8_t NUMBER_SIGN = DOT3 | DOT4 | DOT5 | DOT6; //a-j read as 1-0 until the number ends
+constexpr uint8_t GRADE1_SIGN = DOT5 | DOT6;             //a-j straight after a number are letters
+constexpr uint8_t UNKNOWN_CELL = SIX_DOT_MASK;           //printable character we have no cell for
+
+//cell[c] is the dot pattern for character c, prefix[c] the indicator cell that has to be
+//shown before it (0 if none). Upper case letters and digits share the cells of a-z / a-j,
+//the capital and number signs are what tells them apart.
+struct BrailleTable {
+  uint8_t cell[256];
+  uint8_t prefix[256];
+};
+
+constexpr BrailleTable makeBrailleTable() {
+  BrailleTable t{};
+
+  const uint8_t letters[26] = {
+    DOT1,                             //a
+    DOT1 | DOT2,                      //b
+    DOT1 | DOT4,                      //c
+    DOT1 | DOT4 | DOT5,               //d
+    DOT1 | DOT5,                      //e
+    DOT1 | DOT2 | DOT4,               //f
+    DOT1 | DOT2 | DOT4 | DOT5,        //g
+    DOT1 | DOT2 | DOT5,               //h
+    DOT2 | DOT4,                      //i
+    DOT2 | DOT4 | DOT5,               //j
+    DOT1 | DOT3,                      //k
+    DOT1 | DOT2 | DOT3,               //l
+    DOT1 | DOT3 | DOT4,               //m
+    DOT1 | DOT3 | DOT4 | DOT5,        //n
+    DOT1 | DOT3 | DOT5,               //o
+    DOT1 | DOT2 | DOT3 | DOT4,        //p
+    DOT1 | DOT2 | DOT3 | DOT4 | DOT5, //q
+    DOT1 | DOT2 | DOT3 | DOT5,        //r
+    DOT2 | DOT3 | DOT4,               //s
+    DOT2 | DOT3 | DOT4 | DOT5,        //t
+    DOT1 | DOT3 | DOT6,               //u
+    DOT1 | DOT2 | DOT3 | DOT6,        //v
+    DOT2 | DOT4 | DOT5 | DOT6,        //w
+    DOT1 | DOT3 | DOT4 | DOT6,        //x
+    DOT1 | DOT3 | DOT4 | DOT5 | DOT6, //y
+    DOT1 | DOT3 | DOT5 | DOT6         //z
+  };
+
+  //anything printable we don't know about shows up as a full cell instead of vanishing
+  for (int c = 0x21; c < 0x7F; c++) {
+    t.cell[c] = UNKNOWN_CELL;
+  }
+
+  for (int i = 0; i < 26; i++) {
+    t.cell['a' + i] = letters[i];
+    t.cell['A' + i] = letters[i];
+    t.prefix['A' + i] = CAPITAL_SIGN;
+  }
+
+  for (int i = 0; i < 10; i++) {
+    t.cell['1' + i - (i == 9 ? 10 : 0)] = letters[i]; //1-9 are a-i, 0 is j
+    t.prefix['1' + i - (i == 9 ? 10 : 0)] = NUMBER_SIGN;
+  }
+
+  struct Punct { char c; uint8_t prefix; uint8_t cell; };
+  const Punct punct[] = {
+    {' ',  0,                  0},
+    {',',  0,                  DOT2},
+    {';',  0,                  DOT2 | DOT3},
+    {':',  0,                  DOT2 | DOT5},
+    {'.',  0,                  DOT2 | DOT5 | DOT6},
+    {'!',  0,                  DOT2 | DOT3 | DOT5},
+    {'?',  0,                  DOT2 | DOT3 | DOT6},
+    {'\'', 0,                  DOT3},
+    {'-',  0,                  DOT3 | DOT6},
+    {'"',  DOT6,               DOT2 | DOT3 | DOT5 | DOT6},
+    {'(',  DOT5,               DOT1 | DOT2 | DOT6},
+    {')',  DOT5,               DOT3 | DOT4 | DOT5},
+    {'*',  DOT5,               DOT3 | DOT5},
+    {'+',  DOT5,               DOT2 | DOT3 | DOT5},
+    {'=',  DOT5,               DOT2 | DOT3 | DOT5 | DOT6},
+    {'&',  DOT4,               DOT1 | DOT2 | DOT3 | DOT4 | DOT6},
+    {'@',  DOT4,               DOT1},
+    {'%',  DOT4 | DOT6,        DOT3 | DOT5 | DOT6},
+    {'_',  DOT4 | DOT6,        DOT3 | DOT6},
+    {'/',  DOT4 | DOT5 | DOT6, DOT3 | DOT4},
+    {'#',  DOT4 | DOT5 | DOT6, DOT1 | DOT4 | DOT5 | DOT6}
+  };
+  for (const Punct &p : punct) {
+    t.cell[(uint8_t)p.c] = p.cell;
+    t.prefix[(uint8_t)p.c] = p.prefix;
+  }
+
+  return t;
+}
+
+//built by the compiler, lives in flash
+inline constexpr BrailleTable BRAILLE_TABLE = makeBrailleTable();
+static_assert(BRAILLE_TABLE.prefix['"'] == DOT6 && BRAILLE_TABLE.cell['"'] == (DOT2 | DOT3 | DOT5 | DOT6),
+              "the UEB nonspecific quotation mark is 6-2356, 6-236 is the opening single quote");
+
+inline uint8_t brailleCell(char c) {
+  return BRAILLE_TABLE.cell[(uint8_t)c];
+}
+
+inline uint8_t braillePrefix(char c) {
+  return BRAILLE_TABLE.prefix[(uint8_t)c];
+}
+
+//Grade 1 translation of len characters into at most maxCells cells, adding the capital,
+//number and letter indicators. Returns the number of cells written; never writes past maxCells.
+//If consumed is given it is set to how many characters made it onto the line.
+size_t translateText(const char *text, size_t len, uint8_t *cells, size_t maxCells, size_t *consumed = nullptr);
+
+//8-dot computer braille (North American Computer Braille Code): one cell per character and no
+//indicators, a capital is its letter with dot 7 and a digit has a cell of its own, so mixed case
+//and numbers take no more cells than characters. Control characters add dot 8 to the cell of
+//their letter, bytes above 0x7F add it to the cell of their low 7 bits. Same limits and return
+//value as translateText().
+size_t translateComputer(const char *text, size_t len, uint8_t *cells, size_t maxCells, size_t *consumed = nullptr);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Arduino.h>
+
+enum ButtonId : uint8_t {
+  BUTTON_ENTER,
+  BUTTON_BACK,
+  BUTTON_NEXT,
+  BUTTON_PREV,
+  BUTTON_COUNT
+};
+
+enum ButtonEventType : uint8_t {
+  BUTTON_PRESS,      //button went down
+  BUTTON_LONG_PRESS, //held for LONG_PRESS_MS
+  BUTTON_REPEAT      //still held, every REPEAT_MS after the long press
+};
+
+struct ButtonEvent {
+  uint8_t button;
+  uint8_t type;
+  uint32_t edgeMicros; //micros() of the edge (or timer tick) that caused the event
+};
+
+constexpr uint32_t DEBOUNCE_MS = 20;
+constexpr uint32_t LONG_PRESS_MS = 600;
+constexpr uint32_t REPEAT_MS = 150;
+
+//Buttons are active high (INPUT_PULLDOWN). Each pin gets a CHANGE interrupt that only
+//timestamps the edge into a ring; debouncing, long press and repeat run in the FreeRTOS
+//timer task, which notifies consumer whenever there are events to take.
+void buttonsBegin(const uint8_t pins[BUTTON_COUNT], TaskHandle_t consumer);
+
+//consumer side, false once there are no more events
+bool nextButtonEvent(ButtonEvent &event);
+
+//edges the interrupt had to drop because the ring was full (the timer re-reads the pin then)
+uint32_t buttonEdgesDropped();
+
+//light sleep support: false if a button is down or settling, otherwise every button pin is
+//set to wake the chip when pressed. buttonsWake() puts the pins back to edge interrupts and
+//picks up the press that woke us.
+bool buttonsPrepareSleep();
+void buttonsWake();
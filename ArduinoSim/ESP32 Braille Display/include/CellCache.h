@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "BrailleTable.h"
+
+constexpr uint16_t CELL_CACHE_ENTRIES = 256;
+constexpr uint8_t CELL_CACHE_STRIP = 24; //cells kept per entry, longer names are translated every time
+constexpr uint16_t CELL_CACHE_BUCKETS = 128;
+
+//Translated names kept across menu builds, so rebuilding after a delta or a grade switch only
+//translates the names it hasn't seen. Entries are found by the FNV-1a hash of the text, its length
+//and the table, without keeping the text: two names would have to agree in all three to be mixed
+//up. Fixed capacity; when it is full the least recently used entry makes room. One task only.
+class CellCache {
+public:
+  CellCache();
+
+  //Same as translateWith(), the table is part of the key: at most maxCells cells written, their count returned
+  //(maxCells when they didn't all fit). A strip that was cut short isn't kept.
+  size_t translate(uint8_t table, const char *text, size_t len, uint8_t *cells, size_t maxCells);
+  //forgets every strip, the counters stay
+  void clear();
+
+  uint32_t hits() const { return _hits; }
+  uint32_t misses() const { return _misses; }
+  uint16_t size() const { return _used; }
+  void resetCounters() { _hits = _misses = 0; }
+
+private:
+  struct Entry {
+    uint32_t hash;
+    uint16_t len;   //of the text
+    uint16_t next;  //in its bucket
+    uint16_t older; //the LRU list, newest first
+    uint16_t newer;
+    uint8_t table;
+    uint8_t count;  //cells in the strip
+  };
+
+  static uint16_t bucketOf(uint32_t hash, uint8_t table) {
+    return (hash ^ table * 0x9E3779B1u) & (CELL_CACHE_BUCKETS - 1);
+  }
+  uint16_t find(uint32_t hash, uint8_t table, uint16_t len) const;
+  void unlink(uint16_t i);
+  void pushNewest(uint16_t i);
+  void removeFromBucket(uint16_t i);
+  uint16_t takeSlot();
+
+  Entry _entry[CELL_CACHE_ENTRIES];
+  uint8_t _strip[CELL_CACHE_ENTRIES][CELL_CACHE_STRIP];
+  uint16_t _bucket[CELL_CACHE_BUCKETS];
+  uint16_t _newest;
+  uint16_t _oldest;
+  uint16_t _used;
+  uint32_t _hits = 0;
+  uint32_t _misses = 0;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+//where in a word a contraction is allowed
+enum ContractionContext : uint8_t {
+  CTX_ANYWHERE,  //any part of a word
+  CTX_WORD,      //only as the whole word (wordsigns, shortforms)
+  CTX_START,     //only at the start of a word (be, con, dis, com)
+  CTX_MIDDLE,    //neither the first nor the last letter (ea, bb, cc, ...)
+  CTX_NOT_START  //anywhere but the first letter (ing, ble, final-letter groupsigns)
+};
+
+struct ContractionRule {
+  const char *text;  //lower case letters it replaces
+  uint8_t context;
+  uint8_t cells[3];  //1-3 cells, unused ones are 0
+};
+
+//one letter of a rule. Children of a node are chained through sibling in
+//alphabetical order; node 0 is the root. rule is -1 where no rule ends.
+struct TrieNode {
+  char ch;
+  uint16_t child;
+  uint16_t sibling;
+  int16_t rule;
+};
+
+struct ContractionTable {
+  const TrieNode *nodes;
+  const ContractionRule *rules;
+};
+
+//Unified English Braille grade 2, which is also the South African English code
+extern const ContractionTable UEB_CONTRACTIONS;
+
+//Grade 2 translation: words are contracted with the longest rule that fits its position,
+//numbers and punctuation go through translateText(). Same limits and return value as translateText().
+size_t translateContracted(const ContractionTable &table, const char *text, size_t len,
+                           uint8_t *cells, size_t maxCells);
+
+//whichever translation table names, grade 1 for a table we don't have
+size_t translateWith(uint8_t table, const char *text, size_t len, uint8_t *cells, size_t maxCells);
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <Arduino.h>
+
+//Per core CPU use, sampled from the FreeRTOS tick interrupt of each core: a tick that lands in
+//that core's idle task counts as idle. At 1000 ticks a second this is accurate to a few tenths of
+//a percent over a second. Ticks stop in light sleep, so sleeping time isn't counted at all.
+void cpuLoadBegin();
+
+//busy percentage of core 0 (network) and core 1 (display and input) since the previous call
+void cpuLoadPrint(Print &out);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+constexpr uint16_t DEVICE_LIST_BYTES = 4096;  //biggest payload we take
+constexpr uint16_t DEVICE_LIST_ENTRIES = 256;
+
+//a slice of DeviceList::text, not zero terminated
+struct TextView {
+  uint16_t offset;
+  uint16_t len;
+};
+
+struct DeviceEntry {
+  TextView room;
+  TextView device;
+  uint8_t status;  //STATUS_ON, STATUS_OFF or STATUS_UNKNOWN (WireFormat.h)
+  uint8_t battery; //percent, STATUS_UNKNOWN if it has none
+};
+
+//A device list as it arrived, either the backend's binary snapshot (WireFormat.h) or the text
+//payload "room-dev;dev,room2-dev": rooms are separated by ',', a room's name ends at its first '-'
+//and its devices are separated by ';'. The payload is kept exactly as it is and the entries point
+//into it, in payload order, so entries of the same room are next to each other. Nothing is copied
+//or allocated. Text lists don't know any status.
+struct DeviceList {
+  char text[DEVICE_LIST_BYTES];
+  uint16_t length;
+  DeviceEntry entry[DEVICE_LIST_ENTRIES];
+  uint16_t count;
+  uint16_t rooms;
+  //of the text, or of the names of a binary list, so a status change alone doesn't move it;
+  //0 for a list that failed to parse
+  uint32_t hash;
+  //the backend's catalogue version this list is at, both 0 if it didn't come with one
+  uint32_t epoch;
+  uint32_t version;
+
+  const char *at(TextView view) const { return text + view.offset; }
+};
+
+//Parses a text payload a chunk at a time, e.g. while its TCP segments come in. Each chunk is
+//appended to the list's text and scanned from where the previous one stopped, so a name split
+//over two chunks is no problem: it is in one piece in text once both have arrived.
+class DeviceListParser {
+public:
+  //false (and the payload is ignored) if total doesn't fit in DEVICE_LIST_BYTES
+  bool begin(DeviceList &list, size_t total);
+  //false once the payload is known to be broken or longer than it said
+  bool feed(const char *chunk, size_t len);
+  //false if the payload was broken, incomplete, had too many devices or was an "ERROR: ..." reply;
+  //the list is left empty then. Always call it, even after begin() or feed() failed.
+  bool finish();
+
+private:
+  void scan();
+  void addDevice(uint16_t end);
+
+  DeviceList *_list = nullptr;
+  uint16_t _total = 0;
+  uint16_t _received = 0;
+  uint16_t _scanned = 0;
+  uint16_t _tokenStart = 0;
+  TextView _room = {0, 0};
+  bool _inRoom = true;
+  bool _roomHasDevices = false;
+  bool _ok = false;
+};
+
+//Parses list.text[0, list.length) that is already in place. A binary snapshot is decoded in one
+//bounded pass and sets the list's epoch and version from its header.
+bool parseDeviceList(DeviceList &list);
+
+//Applies a binary delta from the backend to a binary list in place: each record is spliced into
+//list.text, which is decoded again (a status change is just written over the old bytes), and list
+//ends up at the delta's version. False if the delta isn't for list's version (list is untouched
+//then), is broken or doesn't fit; records before the bad one are applied and list's epoch is
+//cleared, so the next request fetches a snapshot.
+bool applyDeviceDelta(DeviceList &list, const char *delta, size_t len);
+
+//Takes the status and battery of every device from from, a list with the same names (same hash),
+//e.g. a snapshot that only brought the version on. Binary lists get the bytes in text as well.
+void copyDeviceStatus(DeviceList &list, const DeviceList &from);
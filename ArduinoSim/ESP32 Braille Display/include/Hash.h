@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+constexpr uint32_t FNV_OFFSET = 2166136261u;
+
+//32 bit FNV-1a; pass the previous result as hash to go on over several blocks
+inline uint32_t fnv1a(const void *data, size_t len, uint32_t hash = FNV_OFFSET) {
+  const uint8_t *p = (const uint8_t *)data;
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ p[i]) * 16777619u;
+  }
+  return hash;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Arduino.h>
+
+//Log2 histogram of latencies in microseconds. Bucket 0 counts 0us, bucket i counts
+//[2^(i-1), 2^i) us and the last bucket everything above. Recording is O(1) and allocation free;
+//one task records, any other task may print (the numbers can be off by the sample in flight).
+class LatencyHistogram {
+public:
+  static constexpr uint8_t BUCKETS = 24; //up to ~8s
+
+  void record(uint32_t us);
+  void reset();
+
+  uint32_t count() const { return _count; }
+  uint32_t max() const { return _max; }
+  //upper bound of the bucket holding the p-th percentile (0-100) or max() if lower, 0 if empty
+  uint32_t percentile(uint8_t p) const;
+
+  //one line summary plus the non-empty buckets
+  void print(Print &out, const char *name) const;
+
+private:
+  static uint32_t bucketLimit(uint8_t i) { return i == 0 ? 0 : (1UL << i) - 1; }
+
+  uint32_t _bucket[BUCKETS] = {};
+  uint32_t _count = 0;
+  uint32_t _max = 0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Arduino.h>
+#include "LatencyHistogram.h"
+
+enum LatencySource : uint8_t {
+  LATENCY_BUTTON, //edge: the button interrupt
+  LATENCY_MQTT,   //edge: first TCP segment of a device list
+  LATENCY_SOURCE_COUNT
+};
+
+enum LatencyStage : uint8_t {
+  STAGE_EDGE,
+  STAGE_DISPATCH,  //the ui task took the event
+  STAGE_TRANSLATE, //the cells to show are known (menu moved, line panned or menu rebuilt)
+  STAGE_BUFFER,    //the changed dots are in the MD_MAX72XX buffer
+  STAGE_SPI,       //the last spiSend() of the frame returned, the dots are lit
+  STAGE_COUNT
+};
+
+//Where an input's time goes on its way to the dots. The ui task opens it with the edge time the
+//input carries, stamps each stage as it gets there and finish() files every stage-to-stage
+//segment and the edge-to-dots total into log2 histograms. Stamps are ignored while nothing is open,
+//so the drawing code can stamp unconditionally. One task records, any other may print.
+class LatencyPipeline {
+public:
+  //stamps STAGE_DISPATCH with now
+  void start(LatencySource source, uint32_t edgeMicros);
+  void stamp(LatencyStage stage, uint32_t at);
+  void stamp(LatencyStage stage) { stamp(stage, micros()); }
+  //records the input if every stage was stamped, then closes it
+  void finish();
+  //the input didn't change the display
+  void cancel() { _open = false; }
+
+  //segment 0 is the total, segment s (1-4) ends at stage s
+  const LatencyHistogram &histogram(LatencySource source, uint8_t segment) const {
+    return _hist[source][segment];
+  }
+  void reset();
+  void print(Print &out) const;
+  //{"button":{"total":{"n":..,"p50":..,"p99":..,"max":..},"dispatch":{..},..},"mqtt":{..}}
+  size_t formatJson(char *buf, size_t size) const;
+
+private:
+  LatencyHistogram _hist[LATENCY_SOURCE_COUNT][STAGE_COUNT];
+  uint32_t _at[STAGE_COUNT];
+  uint8_t _stamped = 0; //bit per stage
+  uint8_t _source = 0;
+  bool _open = false;
+};
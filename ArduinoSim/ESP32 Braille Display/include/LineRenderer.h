@@ -0,0 +1,62 @@
+#pragma once
+
+#include <MD_MAX72xx.h>
+#include <stdint.h>
+#include "BrailleLayout.h"
+
+//Draws the braille line by difference. It keeps the cells that were last committed, XORs them
+//with the new ones and only touches the digit rows holding a dot that changed, so a status word
+//flipping on an otherwise steady line costs one or two SPI frames instead of a repaint.
+//Nothing else may draw the braille line's dots; call invalidate() if something did (e.g. clear()).
+//
+//Over the text sits an overlay, one dot mask per cell of the window, each steady or blinking at
+//its own rate and phase. It is ORed in whenever rows are committed, so a cursor or an attention
+//mark never translates or repaints the text: a blink step only sends the rows its dots are on.
+class LineRenderer {
+public:
+  LineRenderer(MD_MAX72XX &matrix, const LineGeometry &geometry) : _matrix(matrix), _geometry(geometry) {}
+
+  //shows count cells and blanks the rest of the line, returns how many cells changed
+  uint8_t commit(const uint8_t cells[], uint8_t count);
+
+  //Dots shown over window cell `cell` from the next commit() or refresh(). periodMs 0 keeps them
+  //steady, otherwise they are on for periodMs and off for periodMs, phaseMs into that cycle at
+  //time 0. dots 0 takes the cell out of the overlay.
+  void setOverlay(uint8_t cell, uint8_t dots, uint16_t periodMs = 0, uint16_t phaseMs = 0);
+  void clearOverlay();
+  //Moves blinking cells to their phase at nowMs and sends only the rows whose dots changed (none if
+  //no phase did), returns how many cells changed.
+  uint8_t refresh(uint32_t nowMs);
+  //ms from nowMs until a blinking cell changes phase, 0 if nothing blinks
+  uint32_t untilNextPhase(uint32_t nowMs) const;
+  //the next commit() repaints the whole line
+  void invalidate() { _valid = false; }
+
+  //cells rewritten and commits since boot; one task commits, any other may read them
+  uint32_t cellsRewritten() const { return _cellsRewritten; }
+  uint32_t commits() const { return _commits; }
+  //micros() when the last commit had its dots in the buffer and when its last SPI frame was sent
+  uint32_t bufferedAt() const { return _bufferedAt; }
+  uint32_t sentAt() const { return _sentAt; }
+
+private:
+  struct OverlayCell {
+    uint8_t dots;
+    uint16_t periodMs;
+    uint16_t phaseMs;
+  };
+
+  uint8_t draw();
+
+  MD_MAX72XX &_matrix;
+  const LineGeometry &_geometry;
+  uint8_t _text[MAX_LINE_CELLS] = {};  //last committed
+  uint8_t _shown[MAX_LINE_CELLS] = {}; //text and overlay, as on the LEDs
+  OverlayCell _overlay[MAX_LINE_CELLS] = {};
+  uint64_t _dark = 0; //overlay cells in their off phase, one bit each
+  bool _valid = false;
+  uint32_t _cellsRewritten = 0;
+  uint32_t _commits = 0;
+  uint32_t _bufferedAt = 0;
+  uint32_t _sentAt = 0;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "DeviceList.h"
+#include "CellCache.h"
+
+enum MenuKind : uint8_t {
+  MENU_ROOT,
+  MENU_ROOM,
+  MENU_DEVICE,
+  MENU_ACTION
+};
+
+//what an action node does to its device, published as ON / OFF on "<room>/<device>"
+enum MenuAction : uint8_t {
+  ACTION_ON,
+  ACTION_OFF,
+  ACTION_COUNT
+};
+
+constexpr uint16_t NO_NODE = 0xFFFF;
+constexpr uint16_t MENU_NODES = 1 + 2 * DEVICE_LIST_ENTRIES + ACTION_COUNT * DEVICE_LIST_ENTRIES;
+constexpr uint16_t MENU_CELLS = 6144; //every room and device name, translated
+
+//16 bytes, so a navigation step reads exactly one node. Nodes hold no pointers, a built menu can be
+//saved and loaded back as is.
+struct alignas(16) MenuNode {
+  uint16_t parent;
+  uint16_t firstChild;
+  uint16_t next; //siblings, NO_NODE at either end
+  uint16_t prev;
+  uint16_t cells; //pre-translated name, offset in the menu's cell arena
+  uint8_t length;
+  uint8_t kind;
+  uint16_t item; //room or device: its DeviceList entry, action: its MenuAction
+};
+
+static_assert(sizeof(MenuNode) == 16, "a menu node should stay 16 bytes");
+
+//Rooms -> devices -> actions, compiled from a DeviceList into one array of nodes linked by index.
+//Every name is translated once when the menu is built, moving around only changes an index.
+//Rebuilding reuses the same node array and cell arena, nothing is allocated, and names translated
+//for an earlier build come from the strip cache.
+class Menu {
+public:
+  //Replaces the menu with list's rooms and devices, translated with a TranslationTable, and goes
+  //to the first room. Names that don't fit in MENU_CELLS are left blank and false is returned.
+  //list has to outlive the menu.
+  bool build(const DeviceList &list, uint8_t table);
+
+  const MenuNode &current() const { return _node[_current]; }
+  const MenuNode &node(uint16_t index) const { return _node[index]; }
+  const uint8_t *cells(const MenuNode &node) const { return _cells + node.cells; }
+  uint16_t currentIndex() const { return _current; }
+  const DeviceList *list() const { return _list; }
+  //go straight to a node, e.g. to stay in place after rebuilding from the same list
+  bool select(uint16_t index);
+  //first node of kind showing exactly these cells, NO_NODE if there is none
+  uint16_t find(uint8_t kind, const uint8_t *cells, uint8_t length) const;
+
+  //false (and nothing changes) at the end of the siblings, on a leaf or at the top
+  bool next();
+  bool prev();
+  bool enter();
+  bool back();
+
+  //A built menu is two plain blocks, nodeCount() nodes and cellCount() cells. To load one back, read
+  //the blocks into nodeBuffer() and cellBuffer() and call restore() with the list it was built from;
+  //false (and the menu has to be built) if the blocks don't hang together or don't fit list.
+  const MenuNode *nodeData() const { return _node; }
+  uint16_t nodeCount() const { return _count; }
+  const uint8_t *cellData() const { return _cells; }
+  uint16_t cellCount() const { return _cellsUsed; }
+  MenuNode *nodeBuffer() { return _node; }
+  uint8_t *cellBuffer() { return _cells; }
+  bool restore(const DeviceList &list, uint16_t nodes, uint16_t cells);
+
+  //hit and miss counts of the names translated by build()
+  const CellCache &strips() const { return _strips; }
+
+private:
+  uint16_t addNode(uint16_t parent, uint16_t prev, uint8_t kind, uint16_t item,
+                   uint16_t cells, uint8_t length);
+  uint16_t translate(const char *text, size_t len, uint8_t table, uint8_t &length);
+
+  MenuNode _node[MENU_NODES];
+  uint16_t _count = 0;
+  uint16_t _current = 0;
+  uint8_t _cells[MENU_CELLS + 1]; //+1 so translate() can tell an exact fit from a cut off name
+  uint16_t _cellsUsed = 0;
+  bool _full = false;
+  const DeviceList *_list = nullptr;
+  CellCache _strips;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Arduino.h>
+#include "DeviceList.h"
+#include "Menu.h"
+
+//The last device list and its translated menu, kept in LittleFS so the menu can be shown right
+//after power-on instead of after WiFi, the broker and the backend have all answered. The file keeps
+//the list's catalogue version, so the first request after boot only asks for what changed since.
+
+//mounts LittleFS (formatting it the first time); false if there is no filesystem to use
+bool menuCacheBegin();
+//Fills list and menu from the cache and sets table to the TranslationTable it was translated with.
+//False if there is no cache or it doesn't check out, list and menu are unusable then.
+bool menuCacheLoad(DeviceList &list, Menu &menu, uint8_t &table);
+//Replaces the cache. Writing flash stalls both cores for a few ms, don't call it in a hurry.
+bool menuCacheSave(const DeviceList &list, const Menu &menu, uint8_t table);
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Arduino.h>
+#include "DeviceList.h"
+
+enum NetEventType : uint8_t {
+  NET_ONLINE,     //WiFi and the broker are both connected
+  NET_OFFLINE,    //lost one of them, the network task keeps retrying
+  NET_DEVICE_LIST, //a parsed snapshot with its catalogue version, the ui owns list until it releases it
+  NET_DEVICE_DELTA //the changes since the version asked for: list's text is the raw binary delta
+};
+
+struct NetEvent {
+  uint8_t type;
+  DeviceList *list;
+  uint32_t edgeMicros; //when it started, for a device list its first TCP segment
+};
+
+enum NetCommandType : uint8_t {
+  NET_REQUEST_DEVICE_LIST, //"since <epoch> <version> <client>" on deviceList, the backend answers on
+                           //deviceList/response/<client> with a binary delta, snapshot or nothing
+                           //new (WireFormat.h)
+  NET_DEVICE_ACTION        //publish action (a MenuAction) on topic, built by the ui so the network
+                           //task never reads a list the ui keeps changing
+};
+
+constexpr uint8_t ACTION_TOPIC_BYTES = 64; //"<room>/<device>" and its terminator
+
+struct NetCommand {
+  uint8_t type;
+  uint8_t action;
+  uint32_t epoch; //NET_REQUEST_DEVICE_LIST: the catalogue version the ui has, 0 0 for none
+  uint32_t version;
+  char topic[ACTION_TOPIC_BYTES];
+};
+
+//Starts the network task on PRO_CPU (core 0), next to the WiFi driver and the AsyncTCP task,
+//so a TCP retransmit or a broker reconnect never holds up rendering and input on APP_CPU (core 1).
+//The two sides are linked by a pair of SPSC rings and the atomic state of each device list; ui
+//is notified when there are events to take. Returns false and starts nothing if WIFI_SSID / MQTT_HOST aren't configured.
+bool networkBegin(TaskHandle_t ui);
+bool networkEnabled();
+
+//ui side only. sendNetCommand() is false when the network is off or the ring is full.
+bool nextNetEvent(NetEvent &event);
+bool sendNetCommand(const NetCommand &command);
+//The ui is done with the list of a NET_DEVICE_LIST or NET_DEVICE_DELTA, it can be filled again.
+//Not a command: it can't be lost to a full ring, which would keep the list from the network for good.
+void releaseDeviceList(const DeviceList *list);
+
+//Publishes what format writes on braillink/metrics once a minute while online. format runs on the
+//network task and returns the length, or 0 to skip this round. Set it before networkBegin().
+void networkSetMetrics(size_t (*format)(char *buf, size_t size));
+
+//device list replies thrown away because they were broken or both lists were still in use
+uint32_t deviceListsDropped();
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <Arduino.h>
+#include "BrailleLayout.h"
+
+//Which panel this unit has, so one firmware drives any of them. It is one line in /panel on
+//LittleFS: the name of a built-in panel ("13", "20", "32", "40", "2x20") or the panel described
+//as "cells lines cellPitch dotPitch firstRow reversed", e.g. "24 1 5 2 1 1" (see PanelGeometry).
+
+//Reads /panel; LittleFS has to be mounted already (menuCacheBegin()). The prototype if there is no
+//file or it doesn't describe a panel that fits.
+const LineGeometry &panelLoad();
+//Writes config to /panel if it names or describes a panel that fits. The chain is sized at boot,
+//it takes effect after a restart.
+bool panelSave(const char *config);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+
+typedef void (*TaskFunction)();
+
+constexpr uint8_t MAX_SCHEDULED_TASKS = 8;
+constexpr uint32_t MIN_LIGHT_SLEEP_US = 3000; //shorter waits aren't worth the wake up cost
+
+//Cooperative scheduler for loop(). Tasks are kept in a min-heap ordered by their next micros()
+//deadline, run() starts everything that is due and then waits for the earliest deadline,
+//in light sleep if that is allowed. Tasks must return quickly, there is no preemption.
+//Deadlines are compared as signed differences, so periods have to stay below ~35 minutes.
+class Scheduler {
+public:
+  //periodic task, first run straight away. Returns its id, -1 if all slots are taken.
+  int8_t every(const char *name, uint32_t periodMs, TaskFunction fn);
+  //one-shot task, its slot is freed once it has run
+  int8_t after(const char *name, uint32_t delayMs, TaskFunction fn);
+  void cancel(int8_t id);
+
+  //call from loop()
+  void run();
+
+  //light sleep between deadlines. prepare is called first and can veto the sleep (and set up
+  //its wake up sources), wake is called after. nullptr turns light sleep off.
+  void setLightSleep(bool (*prepare)(), void (*wake)());
+
+  //run count, average / worst run time and overruns per task, plus time spent asleep
+  void print(Print &out) const;
+
+private:
+  struct Task {
+    const char *name;
+    TaskFunction fn;
+    uint32_t periodUs; //0 for a one-shot
+    uint32_t due;
+    uint32_t runs;
+    uint32_t overruns; //ran longer than its period, or started a whole period late
+    uint32_t maxUs;
+    uint64_t totalUs;
+  };
+
+  int8_t add(const char *name, uint32_t periodUs, uint32_t delayUs, TaskFunction fn);
+  bool earlier(uint8_t a, uint8_t b) const { return (int32_t)(_task[a].due - _task[b].due) < 0; }
+  void siftUp(uint8_t i);
+  void siftDown(uint8_t i);
+  void push(uint8_t id);
+  void removeAt(uint8_t i);
+  void idle(uint32_t waitUs);
+
+  Task _task[MAX_SCHEDULED_TASKS] = {};
+  uint8_t _heap[MAX_SCHEDULED_TASKS]; //task ids, earliest deadline first
+  uint8_t _count = 0;
+  int8_t _running = -1;
+
+  bool (*_prepareSleep)() = nullptr;
+  void (*_wake)() = nullptr;
+  uint32_t _sleeps = 0;
+  uint64_t _sleptUs = 0;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+//Lock-free ring for exactly one producer and one consumer (an ISR and a task, or two tasks).
+//SIZE has to be a power of two; one slot is never used so full and empty can be told apart.
+//push() is always inlined so it can be called from an IRAM interrupt handler.
+template <typename T, size_t SIZE>
+class SpscRing {
+  static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "ring size must be a power of two");
+
+public:
+  //producer side, false (and the item is dropped) if the ring is full
+  inline __attribute__((always_inline)) bool push(const T &item) {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    uint32_t next = (head + 1) & (SIZE - 1);
+    if (next == _tail.load(std::memory_order_acquire)) {
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    _items[head] = item;
+    _head.store(next, std::memory_order_release);
+    return true;
+  }
+
+  //consumer side, false if there is nothing to take
+  bool pop(T &item) {
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) return false;
+    item = _items[tail];
+    _tail.store((tail + 1) & (SIZE - 1), std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire);
+  }
+
+  //items the producer had to throw away since start up
+  uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+  T _items[SIZE];
+  std::atomic<uint32_t> _head{0};
+  std::atomic<uint32_t> _tail{0};
+  std::atomic<uint32_t> _dropped{0};
+};
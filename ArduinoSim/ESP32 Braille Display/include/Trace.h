@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Arduino.h>
+#include "SpscRing.h"
+
+//what happened, a and b depend on the event
+enum TraceEvent : uint8_t {
+  TRACE_BUTTON,         //a: ButtonId, b: ButtonEventType
+  TRACE_LINE,           //a: cells rewritten, b: pan offset
+  TRACE_ONLINE,
+  TRACE_OFFLINE,
+  TRACE_DEVICE_LIST,    //a: rooms, b: devices
+  TRACE_MENU_FULL,      //some names didn't fit and are blank
+  TRACE_ACTION,         //a: MenuAction, b: DeviceList entry
+  TRACE_ACTION_OFFLINE, //same, not sent
+  TRACE_GRADE,          //a: TranslationTable
+  TRACE_DROPPED,        //added by the drain, b: records lost since the last one
+  TRACE_LIST_UNCHANGED, //same version as the one shown, b: devices
+  TRACE_CACHE_SAVED,    //a: 1 saved, 0 failed
+  TRACE_DEVICE_DELTA,   //a: 1 applied, 0 a snapshot was asked for, b: devices
+  TRACE_EVENT_COUNT
+};
+
+//8 bytes, built in registers and copied into the ring in one go
+struct alignas(8) TraceRecord {
+  uint32_t micros;
+  uint8_t event;
+  uint8_t a;
+  uint16_t b;
+};
+
+enum TraceSink : uint8_t {
+  TRACE_TO_NOTHING, //records are taken and thrown away
+  TRACE_TO_UART,    //one text line each, only as fast as the UART has room
+  TRACE_TO_MQTT     //raw records (little endian) in batches on the "trace" topic
+};
+
+constexpr size_t TRACE_RECORDS = 256; //per core
+constexpr size_t TRACE_BATCH = 64;    //records per MQTT message
+
+//one ring per core; with interrupts masked nothing else on that core can push, so every ring
+//has one producer at a time and the two cores never contend
+extern SpscRing<TraceRecord, TRACE_RECORDS> traceRing[portNUM_PROCESSORS];
+
+//Records an event from any task or interrupt handler without blocking: interrupts are masked on
+//this core while the record goes in, and a full ring drops it. Never formats or touches the UART.
+inline __attribute__((always_inline)) void trace(uint8_t event, uint8_t a = 0, uint16_t b = 0) {
+  TraceRecord record = {(uint32_t)micros(), event, a, b};
+  uint32_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+  traceRing[xPortGetCoreID()].push(record);
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+}
+
+//Starts the drain task. It runs at the lowest priority above idle, so it only gets the CPU
+//when rendering, input and the network have nothing to do.
+void traceBegin(TraceSink sink);
+void traceSetSink(TraceSink sink);
+TraceSink traceSink();
+//records lost because a ring was full
+uint32_t traceDropped();
+
+//network task side of TRACE_TO_MQTT: a batch of raw records waiting to be published, if any.
+//Call traceBatchSent() once it's out; the drain doesn't fill another batch until then.
+bool traceBatch(const uint8_t *&data, size_t &len);
+void traceBatchSent();
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+//The backend's binary replies (services/wireFormat.js builds them), little endian:
+//
+//  header        B1 4C, format, kind, epoch u32, version u32, base u32, rooms u16, records u16
+//  snapshot      rooms x [len u8][room][count u8] then count x [status u8][battery u8][len u8][name]
+//  delta         records x [op u8] then per op
+//                  WIRE_ADD     [len][room][len][device] status battery
+//                  WIRE_REMOVE  [len][room][len][device]
+//                  WIRE_MOVE    [len][room][len][device] [len][room][len][device]
+//                  WIRE_STATUS  [len][room][len][device] status battery
+//
+//Names are counted, not terminated or separated, so they may contain any byte. A snapshot names
+//every room once, followed by its devices, and is at version; a delta takes a list from base to
+//version and has its names inline. A device's status frame is the first 4 header bytes followed
+//by status and battery.
+
+constexpr uint8_t WIRE_MAGIC0 = 0xB1; //can't start UTF-8 text, so a text payload never looks like one
+constexpr uint8_t WIRE_MAGIC1 = 0x4C;
+constexpr uint8_t WIRE_FORMAT = 1;
+constexpr size_t WIRE_HEADER = 20;
+constexpr size_t WIRE_RECORD = 3; //snapshot record in front of a device name
+
+enum WireKind : uint8_t {
+  WIRE_VERSION,  //up to date, nothing follows
+  WIRE_SNAPSHOT,
+  WIRE_DELTA,
+  WIRE_STATUS_FRAME
+};
+
+enum WireOp : uint8_t {
+  WIRE_ADD = 1,
+  WIRE_REMOVE,
+  WIRE_MOVE,
+  WIRE_STATUS
+};
+
+constexpr uint8_t STATUS_OFF = 0;
+constexpr uint8_t STATUS_ON = 1;
+constexpr uint8_t STATUS_UNKNOWN = 0xFF; //also "no battery" for the battery byte
+
+struct WireHeader {
+  uint8_t kind;
+  uint32_t epoch;
+  uint32_t version;
+  uint32_t base;
+  uint16_t rooms;
+  uint16_t records;
+};
+
+//Reads forward through a message. Every read is bounds checked; once one runs past the end
+//ok() stays false and the reads return zeros, so callers check once at the end of a record.
+class WireReader {
+public:
+  WireReader(const uint8_t *data, size_t len) : _p(data), _end(data + len) {}
+
+  bool ok() const { return _ok; }
+  bool done() const { return _p == _end; }
+  const uint8_t *at() const { return _p; }
+
+  uint8_t u8() { return take(1) ? _p[-1] : 0; }
+  uint16_t u16() { return take(2) ? (uint16_t)(_p[-2] | _p[-1] << 8) : 0; }
+  uint32_t u32() {
+    if (!take(4)) return 0;
+    return (uint32_t)_p[-4] | (uint32_t)_p[-3] << 8 | (uint32_t)_p[-2] << 16 | (uint32_t)_p[-1] << 24;
+  }
+  //a counted name, s points at its first byte
+  bool name(const uint8_t *&s, uint8_t &len) {
+    len = u8();
+    s = _p;
+    return take(len);
+  }
+
+private:
+  bool take(size_t n) {
+    if (!_ok || (size_t)(_end - _p) < n) return _ok = false;
+    _p += n;
+    return true;
+  }
+
+  const uint8_t *_p;
+  const uint8_t *_end;
+  bool _ok = true;
+};
+
+//starts like one of our messages, it may still be cut short or broken
+inline bool isWireMessage(const void *data, size_t len) {
+  const uint8_t *p = (const uint8_t *)data;
+  return len >= 3 && p[0] == WIRE_MAGIC0 && p[1] == WIRE_MAGIC1 && p[2] == WIRE_FORMAT;
+}
+
+//false if data isn't a message of our format; the reader is left at the end of the header
+inline bool readWireHeader(WireReader &r, WireHeader &h) {
+  if (r.u8() != WIRE_MAGIC0 || r.u8() != WIRE_MAGIC1 || r.u8() != WIRE_FORMAT) return false;
+  h.kind = r.u8();
+  h.epoch = r.u32();
+  h.version = r.u32();
+  h.base = r.u32();
+  h.rooms = r.u16();
+  h.records = r.u16();
+  return r.ok();
+}
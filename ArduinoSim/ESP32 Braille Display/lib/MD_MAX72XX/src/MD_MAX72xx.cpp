@@ -28,6 +28,12 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
 #if MBED_SPI_ACTIVE
 #include "mbed.h"
 #endif
+#if USE_ESP32_SPI_DMA
+#include <esp_heap_caps.h>
+#endif
+#if USE_ESP32_GPIO_BITBANG
+#include <soc/gpio_reg.h>
+#endif
 
 /**
  * \file
@@ -36,30 +42,51 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
 
 MD_MAX72XX::MD_MAX72XX(moduleType_t mod, int8_t dataPin, int8_t clkPin, int8_t csPin, uint8_t numDevices):
 _dataPin(dataPin), _clkPin(clkPin), _csPin(csPin),
-_hardwareSPI(false), _spiRef(SPI), _maxDevices(numDevices), _updateEnabled(true)
+_hardwareSPI(false), _spiRef(SPI), _spiClock(MAX72XX_SPI_CLOCK_DEFAULT), _maxDevices(numDevices), _updateEnabled(true),
+_frameDepth(0), _frameDeadline(0), _frameStart(0)
 #if MBED_SPI_ACTIVE
 , _spi((PinName)dataPin, NC, (PinName)clkPin), _cs((PinName)csPin)
 #endif
+#if USE_ESP32_SPI_DMA
+, _spiDev(nullptr)
+#endif
+#if USE_LOCAL_FONT && USE_FONT_INDEX
+, _fontIndex(nullptr), _fontIndexShift(0)
+#endif
 {
   setModuleParameters(mod);
 }
 
 MD_MAX72XX::MD_MAX72XX(moduleType_t mod, int8_t csPin, uint8_t numDevices):
 _dataPin(0), _clkPin(0), _csPin(csPin),
-_hardwareSPI(true), _spiRef(SPI), _maxDevices(numDevices), _updateEnabled(true)
+_hardwareSPI(true), _spiRef(SPI), _spiClock(MAX72XX_SPI_CLOCK_DEFAULT), _maxDevices(numDevices), _updateEnabled(true),
+_frameDepth(0), _frameDeadline(0), _frameStart(0)
 #if MBED_SPI_ACTIVE
 , _spi(SPI_MOSI, NC, SPI_SCK), _cs((PinName)csPin)
 #endif
+#if USE_ESP32_SPI_DMA
+, _spiDev(nullptr)
+#endif
+#if USE_LOCAL_FONT && USE_FONT_INDEX
+, _fontIndex(nullptr), _fontIndexShift(0)
+#endif
 {
   setModuleParameters(mod);
 }
 
 MD_MAX72XX::MD_MAX72XX(moduleType_t mod, SPIClass& spi, int8_t csPin, uint8_t numDevices):
   _dataPin(0), _clkPin(0), _csPin(csPin),
-  _hardwareSPI(true), _spiRef(spi), _maxDevices(numDevices), _updateEnabled(true)
+  _hardwareSPI(true), _spiRef(spi), _spiClock(MAX72XX_SPI_CLOCK_DEFAULT), _maxDevices(numDevices), _updateEnabled(true),
+  _frameDepth(0), _frameDeadline(0), _frameStart(0)
 #if MBED_SPI_ACTIVE
   , _spi(SPI_MOSI, NC, SPI_SCK), _cs((PinName)csPin)
 #endif
+#if USE_ESP32_SPI_DMA
+  , _spiDev(nullptr)
+#endif
+#if USE_LOCAL_FONT && USE_FONT_INDEX
+  , _fontIndex(nullptr), _fontIndexShift(0)
+#endif
 {
   setModuleParameters(mod);
 }
@@ -112,6 +139,16 @@ bool MD_MAX72XX::begin(void)
     PRINTS("\nBitBang SPI")
     pinMode(_dataPin, OUTPUT);
     pinMode(_clkPin, OUTPUT);
+#if USE_ESP32_GPIO_BITBANG
+    // pins 32 and up are in the second bank of registers
+    _dataSet = (volatile uint32_t *)(uintptr_t)(_dataPin < 32 ? GPIO_OUT_W1TS_REG : GPIO_OUT1_W1TS_REG);
+    _dataClr = (volatile uint32_t *)(uintptr_t)(_dataPin < 32 ? GPIO_OUT_W1TC_REG : GPIO_OUT1_W1TC_REG);
+    _dataMask = 1UL << (_dataPin & 31);
+    _clkSet = (volatile uint32_t *)(uintptr_t)(_clkPin < 32 ? GPIO_OUT_W1TS_REG : GPIO_OUT1_W1TS_REG);
+    _clkClr = (volatile uint32_t *)(uintptr_t)(_clkPin < 32 ? GPIO_OUT_W1TC_REG : GPIO_OUT1_W1TC_REG);
+    _clkMask = 1UL << (_clkPin & 31);
+    *_clkClr = _clkMask;
+#endif
   }
 
   // initialize our preferred CS pin (could be same as SS)
@@ -128,9 +165,40 @@ bool MD_MAX72XX::begin(void)
 
 
   _matrix = (deviceInfo_t *)malloc(sizeof(deviceInfo_t) * _maxDevices);
+#if USE_ESP32_SPI_DMA
+  _spiData = (uint8_t *)heap_caps_malloc(SPI_DATA_SIZE, MALLOC_CAP_DMA);
+#else
   _spiData = (uint8_t *)malloc(SPI_DATA_SIZE);
+#endif
   b = (_spiData != nullptr) && (_matrix != nullptr);
 
+#if USE_ESP32_SPI_DMA
+  // the default interface is the VSPI host, the IDF driver sends from _spiData directly
+  if (b && _hardwareSPI && &_spiRef == &SPI)
+  {
+    _spiRef.end();
+    if (spiDmaBegin(VSPI_HOST, MOSI, SCK))
+    {
+      PRINTS("\nHardware SPI with DMA");
+    }
+    else
+      _spiRef.begin();
+  }
+
+  // bit bang pins that are a host's IOMUX pins get that host instead, bit bang stays if it won't start
+  if (b && !_hardwareSPI)
+  {
+    if (_dataPin == 23 && _clkPin == 18 && spiDmaBegin(VSPI_HOST, _dataPin, _clkPin))
+    {
+      PRINTS("\nBitBang SPI promoted to VSPI with DMA");
+    }
+    else if (_dataPin == 13 && _clkPin == 14 && spiDmaBegin(HSPI_HOST, _dataPin, _clkPin))
+    {
+      PRINTS("\nBitBang SPI promoted to HSPI with DMA");
+    }
+  }
+#endif
+
   if (b)
   {
     // Initialize the display devices. On initial power-up
@@ -159,13 +227,118 @@ bool MD_MAX72XX::begin(void)
 
 MD_MAX72XX::~MD_MAX72XX(void)
 {
+#if USE_ESP32_SPI_DMA
+  if (_spiDev != nullptr) spiDmaEnd();
+  else
+#endif
 #if !MBED_SPI_ACTIVE
   if (_hardwareSPI) _spiRef.end();  // reset SPI mode
 #endif
 
   free(_matrix);
   free(_spiData);
+#if USE_LOCAL_FONT && USE_FONT_INDEX
+  free(_fontIndex);
+#endif
+}
+
+void MD_MAX72XX::setSpiClock(uint32_t hz)
+{
+  if (hz == 0) return;
+  _spiClock = (hz > MAX72XX_SPI_CLOCK_MAX ? MAX72XX_SPI_CLOCK_MAX : hz);
+
+#if USE_ESP32_SPI_DMA
+  // the driver takes the clock when the device is added
+  if (_spiDev != nullptr)
+  {
+    spi_bus_remove_device(_spiDev);
+    _spiDev = nullptr;
+    if (!spiDmaAddDevice())
+    {
+      spiDmaEnd();
+      if (_hardwareSPI) _spiRef.begin();
+    }
+  }
+#endif
+}
+
+#if USE_ESP32_SPI_DMA
+bool MD_MAX72XX::spiDmaBegin(spi_host_device_t host, int8_t mosi, int8_t sclk)
+{
+  spi_bus_config_t bus = {};
+
+  bus.mosi_io_num = mosi;
+  bus.miso_io_num = -1;   // the MAX72xx has nothing to say
+  bus.sclk_io_num = sclk;
+  bus.quadwp_io_num = -1;
+  bus.quadhd_io_num = -1;
+  bus.max_transfer_sz = SPI_DATA_SIZE;
+
+  if (spi_bus_initialize(host, &bus, SPI_DMA_CH_AUTO) != ESP_OK)
+    return(false);
+
+  _spiHost = host;
+  if (!spiDmaAddDevice())
+  {
+    spi_bus_free(host);
+    return(false);
+  }
+
+  return(true);
+}
+
+bool MD_MAX72XX::spiDmaAddDevice(void)
+{
+  spi_device_interface_config_t dev = {};
+
+  dev.mode = 0;
+  dev.clock_speed_hz = _spiClock;
+  dev.spics_io_num = _csPin;  // low for the whole frame, the rising edge latches it
+  dev.queue_size = 1;
+
+  return(spi_bus_add_device(_spiHost, &dev, &_spiDev) == ESP_OK);
+}
+
+void MD_MAX72XX::spiDmaEnd(void)
+{
+  if (_spiDev != nullptr)
+    spi_bus_remove_device(_spiDev);
+  _spiDev = nullptr;
+  spi_bus_free(_spiHost);
+
+  // the pins back to plain outputs for the SPIClass or bit bang path
+  pinMode(_csPin, OUTPUT);
+  digitalWrite(_csPin, HIGH);
+  if (!_hardwareSPI)
+  {
+    pinMode(_dataPin, OUTPUT);
+    pinMode(_clkPin, OUTPUT);
+  }
+}
+#endif
+
+#if USE_ESP32_GPIO_BITBANG
+void MD_MAX72XX::bitBangSend(void)
+// MSB first; data changes while the clock is low and the devices take it on the rising edge
+{
+  for (uint16_t i = 0; i < SPI_DATA_SIZE; i++)
+  {
+    uint8_t value = _spiData[i];
+
+    for (uint8_t mask = 0x80; mask != 0; mask >>= 1)
+    {
+      if (value & mask)
+        *_dataSet = _dataMask;
+      else
+        *_dataClr = _dataMask;
+      BITBANG_HOLD();
+      *_clkSet = _clkMask;
+      BITBANG_HOLD();
+      *_clkClr = _clkMask;
+    }
+  }
 }
+#endif
 
 void MD_MAX72XX::controlHardware(uint8_t dev, controlRequest_t mode, int value)
 // control command is for the devices, translate internal request to device bytes
@@ -218,7 +391,7 @@ void MD_MAX72XX::controlLibrary(controlRequest_t mode, int value)
   {
     case UPDATE:
       _updateEnabled = (value == ON);
-    if (_updateEnabled) flushBufferAll();
+    if (flushDue()) flushBufferAll();
       break;
 
     case WRAPAROUND:
@@ -298,6 +471,35 @@ void MD_MAX72XX::flushBufferAll()
     _matrix[dev].changed = ALL_CLEAR;
 }
 
+void MD_MAX72XX::beginFrame(void)
+{
+  if (_frameDepth == UINT8_MAX) return;   // deeper than anyone nests, stay in the outermost frame
+  if (_frameDepth++ == 0) _frameStart = millis();
+}
+
+void MD_MAX72XX::commitFrame(void)
+{
+  if (_frameDepth == 0) return;
+  if (--_frameDepth == 0) flushBufferAll();
+}
+
+bool MD_MAX72XX::flushDue(void)
+// Called where a change would be sent straight away with auto updates ON. In a
+// frame the change is left marked in the buffers for commitFrame(), unless the
+// frame has passed its deadline, when everything so far is sent here instead.
+{
+  if (!_updateEnabled) return(false);
+  if (_frameDepth == 0) return(true);
+
+  if (_frameDeadline != 0 && (uint32_t)(millis() - _frameStart) >= _frameDeadline)
+  {
+    flushBufferAll();
+    _frameStart = millis();
+  }
+
+  return(false);
+}
+
 void MD_MAX72XX::flushBuffer(uint8_t buf)
 // Use this function when the changes are limited to one device only.
 // Address passed is a buffer address
@@ -339,21 +541,42 @@ void MD_MAX72XX::spiSend(void)
   _spi.write((const char*)_spiData, SPI_DATA_SIZE, nullptr, 0);
   _cs = 1;
 #else
+#if USE_ESP32_SPI_DMA
+  if (_spiDev != nullptr)
+  {
+    // the whole buffer in one DMA transaction, the peripheral drives CS around it
+    spi_transaction_t t = {};
+
+    t.length = SPI_DATA_SIZE * 8;  // in bits
+    t.tx_buffer = _spiData;
+    spi_device_polling_transmit(_spiDev, &t);
+    return;
+  }
+#endif
+
   // initialize the standard SPI transaction
   if (_hardwareSPI)
-    _spiRef.beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
+    _spiRef.beginTransaction(SPISettings(_spiClock, MSBFIRST, SPI_MODE0));
   digitalWrite(_csPin, LOW);
 
   // shift out the data
   if (_hardwareSPI)
   {
+#if defined(ARDUINO_ARCH_ESP32)
+    _spiRef.writeBytes(_spiData, SPI_DATA_SIZE);  // one call, through the FIFO
+#else
     for (uint16_t i = 0; i < SPI_DATA_SIZE; i++)
       _spiRef.transfer(_spiData[i]);
+#endif
   }
   else  // not hardware SPI - bit bash it out
   {
+#if USE_ESP32_GPIO_BITBANG
+    bitBangSend();
+#else
     for (uint16_t i = 0; i < SPI_DATA_SIZE; i++)
       shiftOut(_dataPin, _clkPin, MSBFIRST, _spiData[i]);
+#endif
   }
 
   // end the SPI transaction
@@ -6,7 +6,11 @@
  */
 
 // Define the selection criteria for MBED SPI handling activation
-#define MBED_SPI_ACTIVE (defined(__MBED__) && !defined(ARDUINO))
+#if defined(__MBED__) && !defined(ARDUINO)
+#define MBED_SPI_ACTIVE 1
+#else
+#define MBED_SPI_ACTIVE 0
+#endif
 
 #if MBED_SPI_ACTIVE
 #warning "INFO: MBED SPI interface selected."
@@ -340,12 +344,96 @@ enough current for the number of connected modules.
 #define USE_LOCAL_FONT 1
 #endif
 
+/**
+ \def USE_FONT_INDEX
+ Set to 1 (default except on AVR) to keep an index of glyph offsets in RAM for
+ the current font, built when the font is set. Finding a character is then a
+ table lookup instead of a walk over every glyph in front of it, which for the
+ last character of a 256 glyph font is 255 steps through the font data.
+ The index takes FONT_INDEX_SIZE * 4 bytes of heap. Set to 0 to save the RAM.
+ */
+#ifndef USE_FONT_INDEX
+#if defined(__AVR__)
+#define USE_FONT_INDEX 0
+#else
+#define USE_FONT_INDEX 1
+#endif
+#endif
+
+/**
+ \def FONT_INDEX_SIZE
+ Number of entries in the glyph offset index (see USE_FONT_INDEX). A font with
+ up to this many characters gets an entry for each one. Larger fonts get one
+ entry per block of 2, 4, 8, ... characters, the smallest block that fits, and a
+ lookup walks at most the rest of one block.
+ */
+#ifndef FONT_INDEX_SIZE
+#define FONT_INDEX_SIZE 256
+#endif
+
+/**
+ \def USE_BIT_TRANSPOSE
+ Set to 1 (default except on AVR) to work on the 8 digits of a device as one
+ 64 bit word when a column has to be gathered from, or spread across, all of
+ them. This is every column access on modules with digits as rows (eg, FC16_HW)
+ and every row access on the others, and the whole device is transposed at once
+ for a rotation. Set to 0 for the bit at a time loops, which suit 8 bit
+ processors better.
+ */
+#ifndef USE_BIT_TRANSPOSE
+#if defined(__AVR__)
+#define USE_BIT_TRANSPOSE 0
+#else
+#define USE_BIT_TRANSPOSE 1
+#endif
+#endif
+
+/**
+ \def USE_ESP32_SPI_DMA
+ Set to 1 (default on the ESP32) to send hardware SPI frames through the ESP-IDF
+ SPI master driver. The data for the whole chain goes out in one DMA transaction
+ with CS driven by the peripheral, instead of one SPIClass::transfer() call per
+ byte. The driver takes over the VSPI host on its default pins, which then cannot
+ be shared with an SPIClass object. Set to 0 to always use the SPIClass object.
+
+ A bit bang chain whose data and clock pins are the IOMUX MOSI and SCK pins of the
+ VSPI (23, 18) or HSPI (13, 14) host is promoted to that host the same way, so
+ the hardware does the shifting without rewiring the board.
+ */
+#ifndef USE_ESP32_SPI_DMA
+#if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_IDF_TARGET_ESP32)
+#define USE_ESP32_SPI_DMA 1
+#else
+#define USE_ESP32_SPI_DMA 0
+#endif
+#endif
+
+#if USE_ESP32_SPI_DMA
+#include <driver/spi_master.h>
+#endif
+
+/**
+ \def USE_ESP32_GPIO_BITBANG
+ Set to 1 (default on the ESP32) to bit bang through the GPIO set and clear
+ registers, with the pin masks worked out once in begin(), instead of calling
+ shiftOut() and so digitalWrite() for every bit.
+ */
+#ifndef USE_ESP32_GPIO_BITBANG
+#if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_IDF_TARGET_ESP32)
+#define USE_ESP32_GPIO_BITBANG 1
+#else
+#define USE_ESP32_GPIO_BITBANG 0
+#endif
+#endif
+
 // Display parameter constants
 // Defined values that are used throughout the library to define physical limits
 #define ROW_SIZE  8   ///< The size in pixels of a row in the device LED matrix array
 #define COL_SIZE  8   ///< The size in pixels of a column in the device LED matrix array
 #define MAX_INTENSITY 0xf ///< The maximum intensity value that can be set for a LED array
 #define MAX_SCANLIMIT 7   ///< The maximum scan limit value that can be set for the devices
+#define MAX72XX_SPI_CLOCK_MAX     10000000 ///< The maximum serial clock of the MAX7219/MAX7221 in Hz
+#define MAX72XX_SPI_CLOCK_DEFAULT 8000000  ///< The hardware SPI clock unless setSpiClock() is used
 
 /**
  * Core object for the MD_MAX72XX library
@@ -443,6 +531,9 @@ public:
    * connect the software to the hardware. Multiple instances may co-exist
    * but they should not share the same hardware CS pin (SPI interface).
    *
+   * On the ESP32 the pins of a hardware SPI host are driven by that host instead
+   * (see USE_ESP32_SPI_DMA).
+   *
    * \param mod       module type used in this application. One of the moduleType_t values.
    * \param dataPin   output on the Arduino where data gets shifted out.
    * \param clkPin    output for the clock signal.
@@ -580,6 +671,25 @@ public:
    * \param mod module type used in this application; one of the moduleType_t values.
    */
   void setModuleType(moduleType_t mod) { setModuleParameters(mod); };
+
+  /**
+   * Set the hardware SPI clock frequency.
+   *
+   * The MAX7219/MAX7221 accept a serial clock of up to 10MHz, higher values are
+   * limited to MAX72XX_SPI_CLOCK_MAX. The default is MAX72XX_SPI_CLOCK_DEFAULT.
+   * The new clock is used from the next transaction and has no effect on the
+   * bit bang interface.
+   *
+   * \param hz  the clock frequency in Hz.
+   */
+  void setSpiClock(uint32_t hz);
+
+  /**
+   * Get the hardware SPI clock frequency.
+   *
+   * \return the clock frequency in Hz.
+   */
+  uint32_t getSpiClock(void) { return(_spiClock); };
   
   /**
    * Set the Shift Data In callback function.
@@ -812,6 +922,95 @@ public:
    */
   void update(void) { flushBufferAll(); };
 
+  /**
+   * Start a display frame.
+   *
+   * Until the matching commitFrame() the library does not write to the devices.
+   * Changed rows are marked dirty in the buffers and accumulate across any
+   * number of setPoint(), setColumn(), setRow(), clear(), etc. calls, so a row
+   * written many times in the frame is sent once. Frames nest; only the
+   * outermost commitFrame() sends the changes.
+   *
+   * This is the same batching as turning auto updates OFF and back ON with
+   * control(), without the caller having to save and restore the UPDATE setting.
+   * See the Frame class for a scope guard that commits when it goes out of scope.
+   */
+  void beginFrame(void);
+
+  /**
+   * End a display frame.
+   *
+   * Ends the frame started by the matching beginFrame(). When this closes the
+   * outermost frame all the rows changed since it started are sent with
+   * flushBufferAll(), one transaction per digit row for all the devices. This
+   * happens even if auto updates are OFF, as the commit is an explicit request.
+   * Calls without an open frame are ignored.
+   */
+  void commitFrame(void);
+
+  /**
+   * Check if a display frame is open.
+   *
+   * \return true between beginFrame() and the matching commitFrame().
+   */
+  bool inFrame(void) { return(_frameDepth != 0); };
+
+  /**
+   * Set the frame deadline.
+   *
+   * A frame held open for longer than the deadline sends the changes made so
+   * far with flushBufferAll() and carries on as a new frame, so a long running
+   * update still shows progress. The deadline is checked when the library would
+   * otherwise have written to the devices, there is no timer, and only while
+   * auto updates are ON. The default of 0 disables the deadline.
+   *
+   * \param ms  the longest a frame is held back in milliseconds, 0 for no limit.
+   */
+  void setFrameDeadline(uint16_t ms) { _frameDeadline = ms; };
+
+  /**
+   * Get the frame deadline.
+   *
+   * \return the deadline in milliseconds, 0 if there is none.
+   */
+  uint16_t getFrameDeadline(void) { return(_frameDeadline); };
+
+  /**
+   * Scope guard for a display frame.
+   *
+   * Calls beginFrame() when it is constructed and commitFrame() when it goes
+   * out of scope, so every exit from a block commits the frame.
+   *
+   * \code
+   * {
+   *   MD_MAX72XX::Frame frame(mx);
+   *   mx.setPoint(0, 0, true);
+   *   mx.setColumn(8, 0x3c);
+   * } // both changes are sent here
+   * \endcode
+   */
+  class Frame
+  {
+  public:
+    /**
+     * Open a frame on the object.
+     *
+     * \param mx  the MD_MAX72XX object to batch the updates of.
+     */
+    explicit Frame(MD_MAX72XX &mx) : _mx(mx) { _mx.beginFrame(); };
+
+    /**
+     * Commit the frame.
+     */
+    ~Frame(void) { _mx.commitFrame(); };
+
+    Frame(const Frame&) = delete;
+    Frame& operator=(const Frame&) = delete;
+
+  private:
+    MD_MAX72XX &_mx;
+  };
+
   /**
    * Turn display wraparound on or off.
    *
@@ -1032,6 +1231,7 @@ private:
   int8_t _csPin;       // ... and LOADed when the chip select pin is driven HIGH to LOW
   bool    _hardwareSPI; // true if SPI interface is the hardware interface
   SPIClass& _spiRef;    // reference to the SPI object to use for hardware comms 
+  uint32_t _spiClock;   // hardware SPI clock in Hz
 
   // Device buffer data
   uint8_t _maxDevices;  // maximum number of devices in use
@@ -1045,12 +1245,24 @@ private:
   // Control data for the library
   bool    _updateEnabled; // update the display when this is true, suspend otherwise
   bool    _wrapAround;    // when shifting, wrap left to right and vice versa (circular buffer)
+  uint8_t _frameDepth;    // nesting depth of beginFrame(), 0 outside a frame
+  uint16_t _frameDeadline;// longest a frame holds back changes in ms, 0 for no limit
+  uint32_t _frameStart;   // millis() when the frame started or last sent at its deadline
 
   // SPI interface data
 #if MBED_SPI_ACTIVE
   SPI   _spi;           // Mbed SPI object
   DigitalOut _cs;
 #endif
+#if USE_ESP32_SPI_DMA
+  spi_device_handle_t _spiDev;  // IDF SPI master device while DMA is in use, nullptr otherwise
+  spi_host_device_t _spiHost;   // the host it is on
+#endif
+#if USE_ESP32_GPIO_BITBANG
+  volatile uint32_t *_dataSet, *_dataClr;  // GPIO write-1-to-set/clear registers of the data pin ...
+  volatile uint32_t *_clkSet, *_clkClr;    // ... and of the clock pin
+  uint32_t _dataMask, _clkMask;            // their bits in those registers
+#endif
 
 #if USE_LOCAL_FONT
   // Font properties info structure
@@ -1068,20 +1280,37 @@ private:
   fontType_t  *_fontData;   // pointer to the current font data being used
   fontInfo_t  _fontInfo;    // properties of the current font table
 
+#if USE_FONT_INDEX
+  uint32_t    *_fontIndex;  // offset of the first character of each block of the current font, nullptr if none
+  uint8_t     _fontIndexShift; // log2 of the characters in a block, 0 when every character has an entry
+#endif
+
   void    setFontInfoDefault(void);      // set the default parameters for the font info file
   void    loadFontInfo(void);            // load the font info block from the font data
   uint8_t getFontWidth(void);            // get the maximum font width by inspecting the font table
   int32_t getFontCharOffset(uint16_t c); // find the character in the font data. If not there, return -1
+#if USE_FONT_INDEX
+  void    loadFontIndex(void);           // build the glyph offset index for the current font
+#endif
 #endif
 
   // Private functions
   void spiSend(void);         // do the actual physical communications task
+#if USE_ESP32_SPI_DMA
+  bool spiDmaBegin(spi_host_device_t host, int8_t mosi, int8_t sclk); // hand a host to the IDF driver
+  bool spiDmaAddDevice(void); // add our chain to it at the current clock
+  void spiDmaEnd(void);       // give the host back
+#endif
+#if USE_ESP32_GPIO_BITBANG
+  void bitBangSend(void);     // shift _spiData out through the GPIO registers
+#endif
   inline void spiClearBuffer(void);  // clear the SPI send buffer
   void controlHardware(uint8_t dev, controlRequest_t mode, int value);  // set hardware control commands
   void controlLibrary(controlRequest_t mode, int value);  // set internal control commands
 
   void flushBuffer(uint8_t buf);  // determine what needs to be sent for one device and transmit
   void flushBufferAll(void);      // determine what needs to be sent for all devices and transmit
+  bool flushDue(void);            // true if changes are to be sent now, rather than held for a frame
 
   uint8_t bitReverse(uint8_t b);  // reverse the order of bits in the byte
   bool transformBuffer(uint8_t buf, transformType_t ttype); // internal transform function
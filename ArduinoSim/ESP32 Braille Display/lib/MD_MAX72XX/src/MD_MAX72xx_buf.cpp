@@ -31,6 +31,69 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
  * \brief Implements buffer related methods
  */
 
+#if USE_BIT_TRANSPOSE
+// The digits of a device as one word, digit i in byte i, so that bit j of every
+// digit is a lane of 8 bits 8 apart. On little endian processors that is the
+// memory layout of the digits, so packing is a copy.
+#define DIGIT_LANES 0x0101010101010101ULL  ///< bit 0 of every digit in the packed word
+
+static inline uint64_t packDigits(const uint8_t *dig)
+{
+  uint64_t x = 0;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  memcpy(&x, dig, sizeof(x));
+#else
+  for (uint8_t i=0; i<ROW_SIZE; i++)
+    x |= (uint64_t)dig[i] << (8*i);
+#endif
+
+  return(x);
+}
+
+static inline void unpackDigits(uint64_t x, uint8_t *dig)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  memcpy(dig, &x, sizeof(x));
+#else
+  for (uint8_t i=0; i<ROW_SIZE; i++)
+    dig[i] = (uint8_t)(x >> (8*i));
+#endif
+}
+
+static inline uint8_t gatherLane(uint64_t x, uint8_t bit)
+// Bit 'bit' of every digit, digit i in bit i of the result. The multiply moves
+// each lane bit to the top byte without any of the partial products overlapping.
+{
+  return((uint8_t)((((x >> bit) & DIGIT_LANES) * 0x0102040810204080ULL) >> 56));
+}
+
+static inline uint64_t spreadLane(uint8_t value)
+// The inverse of gatherLane(), bit i of value in bit 0 of digit i. Every digit
+// gets a copy of value and keeps only its own bit, which is then moved to bit 0.
+{
+  uint64_t x = ((uint64_t)value * DIGIT_LANES) & 0x8040201008040201ULL;
+
+  return((((x & 0x7f7f7f7f7f7f7f7fULL) + 0x7f7f7f7f7f7f7f7fULL) | x) >> 7 & DIGIT_LANES);
+}
+
+static uint64_t transpose8(uint64_t x)
+// Transpose the 8x8 bit matrix, bit j of digit i swaps with bit i of digit j.
+// Swaps the off diagonal bits of each 2x2, then 4x4, then 8x8 block in place.
+{
+  uint64_t t;
+
+  t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaULL;
+  x ^= t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL;
+  x ^= t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL;
+  x ^= t ^ (t << 28);
+
+  return(x);
+}
+#endif
+
 bool MD_MAX72XX::clear(uint8_t buf)
 {
   if (buf > LAST_BUFFER)
@@ -39,7 +102,7 @@ bool MD_MAX72XX::clear(uint8_t buf)
   memset(_matrix[buf].dig, 0, sizeof(_matrix[buf].dig));
   _matrix[buf].changed = ALL_CHANGED;
 
-  if (_updateEnabled) flushBuffer(buf);
+  if (flushDue()) flushBuffer(buf);
 
   return(true);
 }
@@ -71,8 +134,6 @@ bool MD_MAX72XX::copyC(uint8_t buf, uint8_t cSrc, uint8_t cDest)
 // Src and Dest are in pixel coordinates.
 // if we are just copying rows there is no need to repackage any data
 {
-  uint8_t maskSrc = 1 << HW_COL(cSrc);  // which column/row of bits is the column data
-
   if (_hwDigRows) { PRINT("\ncopyCol: (", buf); }
   else { PRINT("\ncopyRow: (", buf); }
   PRINT(", ", cSrc);
@@ -82,6 +143,15 @@ bool MD_MAX72XX::copyC(uint8_t buf, uint8_t cSrc, uint8_t cDest)
   if ((buf > LAST_BUFFER) || (cSrc >= COL_SIZE) || (cDest >= COL_SIZE))
     return(false);
 
+#if USE_BIT_TRANSPOSE
+  uint64_t x = packDigits(_matrix[buf].dig);
+  uint64_t lane = (x >> HW_COL(cSrc)) & DIGIT_LANES;
+
+  x = (x & ~(DIGIT_LANES << HW_COL(cDest))) | (lane << HW_COL(cDest));
+  unpackDigits(x, _matrix[buf].dig);
+#else
+  uint8_t maskSrc = 1 << HW_COL(cSrc);  // which column/row of bits is the column data
+
   for (uint8_t i=0; i<ROW_SIZE; i++)
   {
       if (_matrix[buf].dig[i] & maskSrc)
@@ -89,10 +159,11 @@ bool MD_MAX72XX::copyC(uint8_t buf, uint8_t cSrc, uint8_t cDest)
     else
         bitClear(_matrix[buf].dig[i], HW_COL(cDest));
   }
+#endif
 
   _matrix[buf].changed = ALL_CHANGED;
 
-  if (_updateEnabled) flushBuffer(buf);
+  if (flushDue()) flushBuffer(buf);
 
   return(true);
 }
@@ -113,7 +184,7 @@ bool MD_MAX72XX::copyR(uint8_t buf, uint8_t rSrc, uint8_t rDest)
   _matrix[buf].dig[HW_ROW(rDest)] = _matrix[buf].dig[HW_ROW(rSrc)];
   bitSet(_matrix[buf].changed, HW_ROW(rDest));
 
-  if (_updateEnabled) flushBuffer(buf);
+  if (flushDue()) flushBuffer(buf);
 
   return(true);
 }
@@ -133,7 +204,6 @@ uint8_t MD_MAX72XX::getRow(uint8_t buf, uint8_t r)
 uint8_t MD_MAX72XX::getC(uint8_t buf, uint8_t c)
 // c is in pixel coordinates and the return value must be in pixel coordinate order
 {
-  uint8_t mask = 1 << HW_COL(c);  // which column/row of bits is the column data
   uint8_t value = 0;        // assembles data to be returned to caller
 
   if (_hwDigRows) { PRINT("\ngetCol: (", buf); }
@@ -144,6 +214,13 @@ uint8_t MD_MAX72XX::getC(uint8_t buf, uint8_t c)
   if ((buf > LAST_BUFFER) || (c >= COL_SIZE))
     return(0);
 
+#if USE_BIT_TRANSPOSE
+  // pull the column/row bit out of all the digits at once, in digit order
+  value = gatherLane(packDigits(_matrix[buf].dig), HW_COL(c));
+  if (_hwRevRows) value = bitReverse(value);
+#else
+  uint8_t mask = 1 << HW_COL(c);  // which column/row of bits is the column data
+
   PRINTX("mask 0x", mask);
 
   // for each digit data, pull out the column/row bit and place
@@ -153,6 +230,7 @@ uint8_t MD_MAX72XX::getC(uint8_t buf, uint8_t c)
       if (_matrix[buf].dig[HW_ROW(i)] & mask)
         bitSet(value, i);
   }
+#endif
 
   PRINTX(" value 0x", value);
 
@@ -201,6 +279,14 @@ bool MD_MAX72XX::setC(uint8_t buf, uint8_t c, uint8_t value)
   if ((buf > LAST_BUFFER) || (c >= COL_SIZE))
     return(false);
 
+#if USE_BIT_TRANSPOSE
+  // spread value across the column/row bit of all the digits at once
+  uint64_t x = packDigits(_matrix[buf].dig);
+  uint64_t lane = spreadLane(_hwRevRows ? bitReverse(value) : value);
+
+  x = (x & ~(DIGIT_LANES << HW_COL(c))) | (lane << HW_COL(c));
+  unpackDigits(x, _matrix[buf].dig);
+#else
   for (uint8_t i=0; i<ROW_SIZE; i++)
   {
       if (value & (1 << i))   // mask off next column/row value passed in and set it in the dig buffer
@@ -208,9 +294,10 @@ bool MD_MAX72XX::setC(uint8_t buf, uint8_t c, uint8_t value)
       else
         bitClear(_matrix[buf].dig[HW_ROW(i)], HW_COL(c));
   }
+#endif
   _matrix[buf].changed = ALL_CHANGED;
 
-  if (_updateEnabled) flushBuffer(buf);
+  if (flushDue()) flushBuffer(buf);
 
   return(true);
 }
@@ -229,7 +316,7 @@ bool MD_MAX72XX::setR(uint8_t buf, uint8_t r, uint8_t value)
   _matrix[buf].dig[HW_ROW(r)] = _hwRevCols ? bitReverse(value) : value;
   bitSet(_matrix[buf].changed, HW_ROW(r));
 
-  if (_updateEnabled) flushBuffer(buf);
+  if (flushDue()) flushBuffer(buf);
 
   return(true);
 }
@@ -242,7 +329,7 @@ bool MD_MAX72XX::transform(uint8_t buf, transformType_t ttype)
   if (!transformBuffer(buf, ttype))
     return(false);
 
-  if (_updateEnabled) flushBuffer(buf);
+  if (flushDue()) flushBuffer(buf);
 
   return(true);
 }
@@ -369,11 +456,37 @@ bool MD_MAX72XX::transformBuffer(uint8_t buf, transformType_t ttype)
 
   //--------------
   case TRC: // Transform Rotate Clockwise
+#if USE_BIT_TRANSPOSE
+    {
+      // read and write the direction the digits hold, the transpose gives the other one
+      uint64_t x;
+
+      if (_hwDigRows)
+      {
+        for (uint8_t i=0; i<ROW_SIZE; i++)
+          t[i] = getRow(buf, i);
+        x = transpose8(packDigits(t));  // the columns, new row i is column COL_SIZE-1-i
+
+        for (uint8_t i=0; i<ROW_SIZE; i++)
+          setRow(buf, i, (uint8_t)(x >> (8*(COL_SIZE-1-i))));
+      }
+      else
+      {
+        for (uint8_t i=0; i<ROW_SIZE; i++)
+          t[i] = getColumn(buf, COL_SIZE-1-i);  // the new rows
+        x = transpose8(packDigits(t));  // and so the new columns
+
+        for (uint8_t i=0; i<COL_SIZE; i++)
+          setColumn(buf, i, (uint8_t)(x >> (8*i)));
+      }
+    }
+#else
     for (uint8_t i=0; i<ROW_SIZE; i++)
       t[i] = getColumn(buf, COL_SIZE-1-i);
 
     for (uint8_t i=0; i<ROW_SIZE; i++)
       setRow(buf, i, t[i]);
+#endif
     break;
 
   //--------------
@@ -95,9 +95,51 @@ void MD_MAX72XX::loadFontInfo(void)
 
     // these always set
     _fontInfo.widthMax = getFontWidth();
+#if USE_FONT_INDEX
+    loadFontIndex();
+#endif
   }
 }
 
+#if USE_FONT_INDEX
+void MD_MAX72XX::loadFontIndex(void)
+// Walk the font once and keep the offset of the first character of every block.
+// Blocks are as small as FONT_INDEX_SIZE entries allow, one character for most
+// fonts. Without the memory for the index the lookups fall back to the walk.
+{
+  uint32_t count;
+  uint32_t offset = _fontInfo.dataOffset;
+
+  if (_fontInfo.lastASCII < _fontInfo.firstASCII)
+  {
+    // a broken header has no characters; drop the index of the last font and leave
+    // the lookups to the walk, which finds nothing here either
+    free(_fontIndex);
+    _fontIndex = nullptr;
+    return;
+  }
+  count = (uint32_t)_fontInfo.lastASCII - _fontInfo.firstASCII + 1;
+
+  if (_fontIndex == nullptr)
+    _fontIndex = (uint32_t *)malloc(sizeof(uint32_t) * FONT_INDEX_SIZE);
+  if (_fontIndex == nullptr)
+    return;
+
+  _fontIndexShift = 0;
+  while (((count - 1) >> _fontIndexShift) >= FONT_INDEX_SIZE)
+    _fontIndexShift++;
+
+  PRINT("\nFont index block ", 1 << _fontIndexShift);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if ((i & ((1UL << _fontIndexShift) - 1)) == 0)
+      _fontIndex[i >> _fontIndexShift] = offset;
+    offset += pgm_read_byte(_fontData + offset);
+    offset++; // skip size byte
+  }
+}
+#endif
+
 uint8_t MD_MAX72XX::getFontWidth(void)
 {
   uint8_t   max = 0;
@@ -137,6 +179,21 @@ int32_t MD_MAX72XX::getFontCharOffset(uint16_t c)
 
   if (c < _fontInfo.firstASCII || c > _fontInfo.lastASCII)
     offset = -1;
+#if USE_FONT_INDEX
+  else if (_fontIndex != nullptr)
+  {
+    uint16_t i = c - _fontInfo.firstASCII;
+
+    offset = _fontIndex[i >> _fontIndexShift];
+    for (i &= (1U << _fontIndexShift) - 1; i > 0; i--)
+    {
+      offset += pgm_read_byte(_fontData+offset);
+      offset++; // skip size byte
+    }
+
+    PRINT(" indexed offset ", offset);
+  }
+#endif
   else
   {
     for (uint16_t i=_fontInfo.firstASCII; i<c; i++)
@@ -213,7 +270,7 @@ uint8_t MD_MAX72XX::setChar(uint16_t col, uint16_t c)
   }
   _updateEnabled = b;
 
-  if (_updateEnabled) flushBufferAll();
+  if (flushDue()) flushBufferAll();
 
   return(size);
 }
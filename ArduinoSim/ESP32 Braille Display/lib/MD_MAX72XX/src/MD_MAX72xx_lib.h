@@ -45,6 +45,13 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
 #define PRINTS(s)     ///< Print a string
 #endif
 
+#if USE_ESP32_GPIO_BITBANG
+// The MAX7219 needs the clock high and low for 50ns each and data set up 25ns before
+// the rising edge. GPIO register writes can be quicker than that, so each half of a
+// bit is held for at least 12 CPU cycles (50ns at 240MHz, longer at lower clocks).
+#define BITBANG_HOLD() __asm__ __volatile__("nop; nop; nop; nop; nop; nop; nop; nop; nop; nop; nop; nop")  ///< Hold a bit bang clock phase
+#endif
+
 // Opcodes for the MAX7221 and MAX7219
 // All OP_DIGITn are offsets from OP_DIGIT0
 #define OP_NOOP       0 ///< MAX72xx opcode for NO OP
@@ -44,7 +44,7 @@ void MD_MAX72XX::clear(uint8_t startDev, uint8_t endDev)
     _matrix[buf].changed = ALL_CHANGED;
   }
 
-  if (_updateEnabled) flushBufferAll();
+  if (flushDue()) flushBufferAll();
 }
 
 bool MD_MAX72XX::getBuffer(uint16_t col, uint8_t size, uint8_t *pd)
@@ -70,7 +70,7 @@ bool MD_MAX72XX::setBuffer(uint16_t col, uint8_t size, uint8_t *pd)
     setColumn(col--, *pd++);
   _updateEnabled = b;
 
-  if (_updateEnabled) flushBufferAll();
+  if (flushDue()) flushBufferAll();
 
   return(true);
 }
@@ -127,7 +127,7 @@ bool MD_MAX72XX::setPoint(uint8_t r, uint16_t c, bool state)
   else
     bitSet(_matrix[buf].changed, HW_ROW(c));
 
-  if (_updateEnabled) flushBuffer(buf);
+  if (flushDue()) flushBuffer(buf);
 
   return(true);
 }
@@ -146,7 +146,7 @@ bool MD_MAX72XX::setRow(uint8_t startDev, uint8_t endDev, uint8_t r, uint8_t val
     setRow(i, r, value);
   _updateEnabled = b;
 
-  if (_updateEnabled) flushBufferAll();
+  if (flushDue()) flushBufferAll();
 
   return(true);
 }
@@ -248,7 +248,7 @@ bool MD_MAX72XX::transform(uint8_t startDev, uint8_t endDev, transformType_t tty
 
   _updateEnabled = b;
 
-  if (_updateEnabled) flushBufferAll();
+  if (flushDue()) flushBufferAll();
 
   return(true);
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "BrailleLayout.h"
+#include <string.h>
+
+//cell 1 at the far end of each line, 5 columns a cell like the prototype
+constexpr PanelGeometry PANEL_20 = {20, 1, 5, 2, 1, true};
+constexpr PanelGeometry PANEL_32 = {32, 1, 5, 2, 1, true};
+constexpr PanelGeometry PANEL_40 = {40, 1, 5, 2, 1, true};
+constexpr PanelGeometry PANEL_2X20 = {20, 2, 5, 2, 1, true};
+
+static_assert(panelFits(PANEL_20) && panelFits(PANEL_32) && panelFits(PANEL_40) && panelFits(PANEL_2X20),
+              "a built-in panel doesn't fit MAX_LINE_CELLS / MAX_LINE_DEVICES");
+
+const LineGeometry PANELS[] = {
+  //column pairs measured on the prototype, cell 1 first
+  {"13", 13, 8, {
+    cellAt(57, 59),
+    cellAt(62, 48),
+    cellAt(51, 53),
+    cellAt(40, 42),
+    cellAt(45, 47),
+    cellAt(34, 36),
+    cellAt(39, 25),
+    cellAt(28, 30),
+    cellAt(17, 19),
+    cellAt(22, 8),
+    cellAt(11, 13),
+    cellAt(0, 2),
+    cellAt(5, 7)
+  }},
+  makeGeometry("20", PANEL_20),
+  makeGeometry("32", PANEL_32),
+  makeGeometry("40", PANEL_40),
+  makeGeometry("2x20", PANEL_2X20)
+};
+const uint8_t PANEL_COUNT = sizeof(PANELS) / sizeof(PANELS[0]);
+
+const LineGeometry *findPanel(const char *name) {
+  for (const LineGeometry &g : PANELS) {
+    if (strcmp(g.name, name) == 0) return &g;
+  }
+  return nullptr;
+}
+
+//Only the modules the panel has are touched, so the cost goes with its size, not the biggest one.
+void blitCells(MD_MAX72XX &matrix, const LineGeometry &geometry, const uint8_t cells[], uint8_t count) {
+  uint8_t frame[MAX_LINE_DEVICES][ROW_SIZE];
+  uint8_t owned[MAX_LINE_DEVICES][ROW_SIZE]; //bits that belong to the braille line
+  memset(frame, 0, geometry.devices * ROW_SIZE);
+  memset(owned, 0, geometry.devices * ROW_SIZE);
+
+  if (count > geometry.cells) count = geometry.cells;
+
+  for (uint8_t i = 0; i < geometry.cells; i++) {
+    uint8_t cell = i < count ? cells[i] : 0;
+    for (uint8_t d = 0; d < 8; d++) {
+      const DotTarget &t = geometry.cell[i].dot[d];
+      owned[t.device][t.digit] |= t.mask;
+      if (bitRead(cell, d)) frame[t.device][t.digit] |= t.mask;
+    }
+  }
+
+  MD_MAX72XX::Frame commit(matrix); //one flushBufferAll() on the way out
+  for (uint8_t dev = 0; dev < geometry.devices; dev++) {
+    for (uint8_t dig = 0; dig < ROW_SIZE; dig++) {
+      if (owned[dev][dig] == 0) continue;
+
+      uint8_t old = matrix.getRow(dev, dig);
+      uint8_t value = (old & ~owned[dev][dig]) | frame[dev][dig];
+      if (value != old) matrix.setRow(dev, dig, value);
+    }
+  }
+}
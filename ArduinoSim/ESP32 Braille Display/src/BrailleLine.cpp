@@ -0,0 +1,57 @@
+#include "BrailleLine.h"
+#include "Contractions.h"
+
+void BrailleLine::setText(const char *text, size_t len, uint8_t table) {
+  _length = translateWith(table, text, len, _cells, LINE_BUFFER_CELLS);
+  _strip = _cells;
+  _offset = 0;
+}
+
+void BrailleLine::showCells(const uint8_t *cells, uint16_t count) {
+  _strip = cells;
+  _length = count;
+  _offset = 0;
+}
+
+uint8_t BrailleLine::visibleCount() const {
+  uint16_t left = _length - _offset;
+  return left < _width ? left : _width;
+}
+
+bool BrailleLine::panRight() {
+  if (_offset + _width >= _length) return false;
+  _offset += _width;
+  return true;
+}
+
+bool BrailleLine::panLeft() {
+  if (_offset == 0) return false;
+  _offset = _offset > _width ? _offset - _width : 0;
+  return true;
+}
+
+bool BrailleLine::home() {
+  if (_offset == 0) return false;
+  _offset = 0;
+  return true;
+}
+
+bool BrailleLine::nextWord() {
+  for (uint16_t i = _offset + 1; i < _length; i++) {
+    if (wordStart(i)) {
+      _offset = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BrailleLine::prevWord() {
+  for (uint16_t i = _offset; i > 0; i--) {
+    if (wordStart(i - 1)) {
+      _offset = i - 1;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,100 @@
+#include "BrailleTable.h"
+
+//NABCC cells of 0x20-0x5F as dot numbers; 0x60-0x7F are 0x40-0x5F without dot 7
+static constexpr const char *COMPUTER_DOTS[64] = {
+  "",      "2346", "5",     "3456",  "1246", "146",   "12346", "3",
+  "12356", "23456", "16",   "346",   "6",    "36",    "46",    "34",
+  "356",   "2",     "23",   "25",    "256",  "26",    "235",   "2356",
+  "236",   "35",    "156",  "56",    "126",  "123456", "345",  "1456",
+  "4",     "1",     "12",   "14",    "145",  "15",    "124",   "1245",
+  "125",   "24",    "245",  "13",    "123",  "134",   "1345",  "135",
+  "1234",  "12345", "1235", "234",   "2345", "136",   "1236",  "2456",
+  "1346",  "13456", "1356", "246",   "1256", "12456", "45",    "456"
+};
+
+struct ComputerTable {
+  uint8_t cell[256];
+};
+
+static constexpr ComputerTable makeComputerTable() {
+  ComputerTable t{};
+  for (int i = 0; i < 64; i++) {
+    uint8_t cell = 0;
+    for (const char *d = COMPUTER_DOTS[i]; *d; d++) cell |= 1 << (*d - '1');
+    t.cell[0x20 + i] = cell | (i >= 0x20 ? DOT7 : 0); //capitals and @[\]^_
+  }
+  for (int c = 0x60; c < 0x80; c++) t.cell[c] = t.cell[c - 0x20] & ~DOT7;
+  for (int c = 0; c < 0x20; c++) t.cell[c] = t.cell[c + 0x40] | DOT8;
+  for (int c = 0x80; c < 0x100; c++) t.cell[c] = t.cell[c - 0x80] | DOT8;
+  return t;
+}
+
+//built by the compiler, lives in flash
+static constexpr ComputerTable COMPUTER_TABLE = makeComputerTable();
+
+static bool isUpper(char c) { return c >= 'A' && c <= 'Z'; }
+static bool isLower(char c) { return c >= 'a' && c <= 'z'; }
+static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+static bool isLetter(char c) { return isUpper(c) || isLower(c); }
+
+//true if the run of letters starting at text[i] is all capitals and longer than one letter
+static bool capitalWord(const char *text, size_t i, size_t len) {
+  size_t letters = 0;
+  for (; i < len && isLetter(text[i]); i++, letters++) {
+    if (!isUpper(text[i])) return false;
+  }
+  return letters > 1;
+}
+
+size_t translateText(const char *text, size_t len, uint8_t *cells, size_t maxCells, size_t *consumed) {
+  size_t n = 0;
+  size_t i = 0;
+  bool numeric = false;  //inside a number, a-j are digits
+  bool capsWord = false; //inside a word opened with the capitals word indicator
+
+  for (; i < len; i++) {
+    char c = text[i];
+    uint8_t pre[2];
+    size_t npre = 0;
+
+    if (isDigit(c)) {
+      if (!numeric) pre[npre++] = NUMBER_SIGN;
+      numeric = true;
+    } else if (numeric && (c == '.' || c == ',') && i + 1 < len && isDigit(text[i + 1])) {
+      //decimal point or thousands separator, the number carries on
+    } else {
+      if (isUpper(c)) {
+        if (!capsWord && (i == 0 || !isLetter(text[i - 1])) && capitalWord(text, i, len)) {
+          pre[npre++] = CAPITAL_SIGN;
+          pre[npre++] = CAPITAL_SIGN;
+          capsWord = true;
+        } else if (!capsWord) {
+          pre[npre++] = CAPITAL_SIGN;
+        }
+      } else if (numeric && c >= 'a' && c <= 'j') {
+        pre[npre++] = GRADE1_SIGN;
+      } else if (braillePrefix(c)) {
+        pre[npre++] = braillePrefix(c);
+      }
+      if (!isLetter(c)) capsWord = false;
+      numeric = false;
+    }
+
+    //an indicator is never split from its cell
+    if (n + npre + 1 > maxCells) break;
+    for (size_t p = 0; p < npre; p++) {
+      cells[n++] = pre[p];
+    }
+    cells[n++] = brailleCell(c);
+  }
+
+  if (consumed) *consumed = i;
+  return n;
+}
+
+size_t translateComputer(const char *text, size_t len, uint8_t *cells, size_t maxCells, size_t *consumed) {
+  size_t n = len < maxCells ? len : maxCells;
+  for (size_t i = 0; i < n; i++) cells[i] = COMPUTER_TABLE.cell[(uint8_t)text[i]];
+  if (consumed) *consumed = n;
+  return n;
+}
@@ -0,0 +1,166 @@
+#include "Buttons.h"
+#include <freertos/timers.h>
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include "SpscRing.h"
+
+struct Edge {
+  uint8_t button;
+  uint8_t level;
+  uint32_t micros;
+};
+
+struct ButtonState {
+  uint8_t pin;
+  bool down;           //debounced level
+  bool longSent;       //long press already reported for this press
+  uint32_t changedAt;  //micros() of the last accepted change
+  uint32_t nextRepeat; //micros() the next repeat is due
+};
+
+constexpr uint32_t DEBOUNCE_US = DEBOUNCE_MS * 1000;
+constexpr uint32_t LONG_PRESS_US = LONG_PRESS_MS * 1000;
+constexpr uint32_t REPEAT_US = REPEAT_MS * 1000;
+constexpr TickType_t POLL_TICKS = pdMS_TO_TICKS(10);
+
+static ButtonState buttons[BUTTON_COUNT];
+static SpscRing<Edge, 32> edges;         //interrupt -> timer task
+static SpscRing<ButtonEvent, 16> events; //timer task -> consumer
+static std::atomic<uint32_t> pended{0};  //a debounce call is already queued for the timer task
+static TaskHandle_t consumerTask;
+static TimerHandle_t pollTimer;
+
+static void emit(uint8_t button, uint8_t type, uint32_t at, bool &any) {
+  events.push({button, type, at});
+  any = true;
+}
+
+static void accept(uint8_t button, bool down, uint32_t at, bool &any) {
+  ButtonState &s = buttons[button];
+  s.down = down;
+  s.changedAt = at;
+  s.longSent = false;
+  if (down) emit(button, BUTTON_PRESS, at, any);
+}
+
+//Only ever runs in the timer task, either queued by the interrupt or from the poll timer,
+//so it is the single consumer of edges and the single producer of events.
+static void debounce(void *, uint32_t) {
+  pended.store(0);
+  bool any = false;
+  Edge e;
+
+  //leading edge: the first edge after DEBOUNCE_US of quiet is the press or release,
+  //the bounces that follow it fall inside the window and are ignored
+  while (edges.pop(e)) {
+    ButtonState &s = buttons[e.button];
+    if ((bool)e.level != s.down && e.micros - s.changedAt >= DEBOUNCE_US) {
+      accept(e.button, e.level, e.micros, any);
+    }
+  }
+
+  uint32_t now = micros();
+  bool busy = false; //something is held or settling, keep polling
+  for (uint8_t b = 0; b < BUTTON_COUNT; b++) {
+    ButtonState &s = buttons[b];
+    uint32_t since = now - s.changedAt;
+    if (since < DEBOUNCE_US) {
+      busy = true;
+      continue;
+    }
+
+    //a release inside the debounce window (or a dropped edge) leaves us out of step with the pin
+    bool level = digitalRead(s.pin) == HIGH;
+    if (level != s.down) {
+      accept(b, level, now, any);
+      busy = true;
+      continue;
+    }
+    if (!s.down) continue;
+
+    busy = true;
+    if (!s.longSent && since >= LONG_PRESS_US) {
+      emit(b, BUTTON_LONG_PRESS, now, any);
+      s.longSent = true;
+      s.nextRepeat = now + REPEAT_US;
+    } else if (s.longSent && (int32_t)(now - s.nextRepeat) >= 0) {
+      emit(b, BUTTON_REPEAT, now, any);
+      s.nextRepeat += REPEAT_US;
+    }
+  }
+
+  if (any) xTaskNotifyGive(consumerTask);
+
+  //the poll timer only runs while a button is down, idle buttons cost nothing
+  bool active = xTimerIsTimerActive(pollTimer) != pdFALSE;
+  if (busy && !active) {
+    xTimerStart(pollTimer, 0);
+  } else if (!busy && active) {
+    xTimerStop(pollTimer, 0);
+  }
+}
+
+static void onPollTimer(TimerHandle_t) {
+  debounce(nullptr, 0);
+}
+
+static void IRAM_ATTR onEdge(void *arg) {
+  uint8_t button = (uint8_t)(uintptr_t)arg;
+  edges.push({button, (uint8_t)digitalRead(buttons[button].pin), (uint32_t)micros()});
+
+  //run the debouncer now rather than at the next poll; one queued call covers a burst of bounces
+  if (pended.exchange(1) == 0) {
+    BaseType_t woken = pdFALSE;
+    if (xTimerPendFunctionCallFromISR(debounce, nullptr, 0, &woken) != pdPASS) pended.store(0);
+    if (woken) portYIELD_FROM_ISR();
+  }
+}
+
+void buttonsBegin(const uint8_t pins[BUTTON_COUNT], TaskHandle_t consumer) {
+  consumerTask = consumer;
+  pollTimer = xTimerCreate("buttons", POLL_TICKS, pdTRUE, nullptr, onPollTimer);
+
+  uint32_t now = micros();
+  for (uint8_t b = 0; b < BUTTON_COUNT; b++) {
+    ButtonState &s = buttons[b];
+    s.pin = pins[b];
+    pinMode(s.pin, INPUT_PULLDOWN);
+    s.down = digitalRead(s.pin) == HIGH;
+    s.longSent = s.down; //held since power up, not a long press
+    s.changedAt = now;
+    attachInterruptArg(s.pin, onEdge, (void *)(uintptr_t)b, CHANGE);
+  }
+}
+
+bool nextButtonEvent(ButtonEvent &event) {
+  return events.pop(event);
+}
+
+uint32_t buttonEdgesDropped() {
+  return edges.dropped();
+}
+
+bool buttonsPrepareSleep() {
+  if (xTimerIsTimerActive(pollTimer) != pdFALSE || !edges.empty()) return false;
+  for (uint8_t b = 0; b < BUTTON_COUNT; b++) {
+    if (buttons[b].down) return false;
+  }
+  //wake up is level triggered and replaces the pin's edge interrupt until buttonsWake()
+  for (uint8_t b = 0; b < BUTTON_COUNT; b++) {
+    gpio_wakeup_enable((gpio_num_t)buttons[b].pin, GPIO_INTR_HIGH_LEVEL);
+  }
+  esp_sleep_enable_gpio_wakeup();
+  return true;
+}
+
+void buttonsWake() {
+  for (uint8_t b = 0; b < BUTTON_COUNT; b++) {
+    gpio_wakeup_disable((gpio_num_t)buttons[b].pin);
+    gpio_set_intr_type((gpio_num_t)buttons[b].pin, GPIO_INTR_ANYEDGE);
+  }
+  //the edge happened while asleep, let the debouncer read the pins
+  //a full timer queue leaves it to the next edge or poll, as in onEdge
+  if (pended.exchange(1) == 0) {
+    if (xTimerPendFunctionCall(debounce, nullptr, 0, 0) != pdPASS) pended.store(0);
+  }
+}
@@ -0,0 +1,90 @@
+#include "CellCache.h"
+#include <string.h>
+#include "Contractions.h"
+#include "Hash.h"
+
+constexpr uint16_t NONE = 0xFFFF;
+
+static_assert((CELL_CACHE_BUCKETS & (CELL_CACHE_BUCKETS - 1)) == 0, "buckets are picked with a mask");
+
+CellCache::CellCache() {
+  clear();
+}
+
+void CellCache::clear() {
+  for (uint16_t &b : _bucket) b = NONE;
+  _newest = _oldest = NONE;
+  _used = 0;
+}
+
+uint16_t CellCache::find(uint32_t hash, uint8_t table, uint16_t len) const {
+  for (uint16_t i = _bucket[bucketOf(hash, table)]; i != NONE; i = _entry[i].next) {
+    const Entry &e = _entry[i];
+    if (e.hash == hash && e.len == len && e.table == table) return i;
+  }
+  return NONE;
+}
+
+void CellCache::unlink(uint16_t i) {
+  Entry &e = _entry[i];
+  if (e.newer != NONE) _entry[e.newer].older = e.older;
+  else _newest = e.older;
+  if (e.older != NONE) _entry[e.older].newer = e.newer;
+  else _oldest = e.newer;
+}
+
+void CellCache::pushNewest(uint16_t i) {
+  Entry &e = _entry[i];
+  e.newer = NONE;
+  e.older = _newest;
+  if (_newest != NONE) _entry[_newest].newer = i;
+  _newest = i;
+  if (_oldest == NONE) _oldest = i;
+}
+
+void CellCache::removeFromBucket(uint16_t i) {
+  uint16_t *link = &_bucket[bucketOf(_entry[i].hash, _entry[i].table)];
+  while (*link != i) link = &_entry[*link].next;
+  *link = _entry[i].next;
+}
+
+//a free entry, or the least recently used one taken out of the cache
+uint16_t CellCache::takeSlot() {
+  if (_used < CELL_CACHE_ENTRIES) return _used++;
+  uint16_t i = _oldest;
+  unlink(i);
+  removeFromBucket(i);
+  return i;
+}
+
+size_t CellCache::translate(uint8_t table, const char *text, size_t len, uint8_t *cells, size_t maxCells) {
+  uint32_t hash = fnv1a(text, len);
+  uint16_t i = len <= 0xFFFF ? find(hash, table, len) : NONE;
+  if (i != NONE) {
+    _hits++;
+    if (i != _newest) {
+      unlink(i);
+      pushNewest(i);
+    }
+    size_t n = _entry[i].count < maxCells ? _entry[i].count : maxCells;
+    memcpy(cells, _strip[i], n);
+    return n;
+  }
+
+  _misses++;
+  size_t n = translateWith(table, text, len, cells, maxCells);
+  if (n == maxCells || n > CELL_CACHE_STRIP || len > 0xFFFF) return n;
+
+  i = takeSlot();
+  Entry &e = _entry[i];
+  e.hash = hash;
+  e.len = len;
+  e.table = table;
+  e.count = n;
+  uint16_t &bucket = _bucket[bucketOf(hash, table)];
+  e.next = bucket;
+  bucket = i;
+  pushNewest(i);
+  memcpy(_strip[i], cells, n);
+  return n;
+}
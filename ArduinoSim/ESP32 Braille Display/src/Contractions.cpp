@@ -0,0 +1,350 @@
+#include "Contractions.h"
+#include "BrailleTable.h"
+
+//"1246" -> dots 1, 2, 4 and 6, so the rules read like a braille reference
+static constexpr uint8_t dots(const char *d) {
+  uint8_t cell = 0;
+  for (; *d; d++) {
+    cell |= 1 << (*d - '1');
+  }
+  return cell;
+}
+
+static constexpr ContractionRule UEB_RULES[] = {
+  //alphabetic wordsigns
+  {"but",       CTX_WORD,      {dots("12")}},
+  {"can",       CTX_WORD,      {dots("14")}},
+  {"do",        CTX_WORD,      {dots("145")}},
+  {"every",     CTX_WORD,      {dots("15")}},
+  {"from",      CTX_WORD,      {dots("124")}},
+  {"go",        CTX_WORD,      {dots("1245")}},
+  {"have",      CTX_WORD,      {dots("125")}},
+  {"just",      CTX_WORD,      {dots("245")}},
+  {"knowledge", CTX_WORD,      {dots("13")}},
+  {"like",      CTX_WORD,      {dots("123")}},
+  {"more",      CTX_WORD,      {dots("134")}},
+  {"not",       CTX_WORD,      {dots("1345")}},
+  {"people",    CTX_WORD,      {dots("1234")}},
+  {"quite",     CTX_WORD,      {dots("12345")}},
+  {"rather",    CTX_WORD,      {dots("1235")}},
+  {"so",        CTX_WORD,      {dots("234")}},
+  {"that",      CTX_WORD,      {dots("2345")}},
+  {"us",        CTX_WORD,      {dots("136")}},
+  {"very",      CTX_WORD,      {dots("1236")}},
+  {"will",      CTX_WORD,      {dots("2456")}},
+  {"it",        CTX_WORD,      {dots("1346")}},
+  {"you",       CTX_WORD,      {dots("13456")}},
+  {"as",        CTX_WORD,      {dots("1356")}},
+
+  //strong contractions
+  {"and",       CTX_ANYWHERE,  {dots("12346")}},
+  {"for",       CTX_ANYWHERE,  {dots("123456")}},
+  {"of",        CTX_ANYWHERE,  {dots("12356")}},
+  {"the",       CTX_ANYWHERE,  {dots("2346")}},
+  {"with",      CTX_ANYWHERE,  {dots("23456")}},
+
+  //strong wordsigns
+  {"child",     CTX_WORD,      {dots("16")}},
+  {"shall",     CTX_WORD,      {dots("146")}},
+  {"this",      CTX_WORD,      {dots("1456")}},
+  {"which",     CTX_WORD,      {dots("156")}},
+  {"out",       CTX_WORD,      {dots("1256")}},
+  {"still",     CTX_WORD,      {dots("34")}},
+
+  //strong groupsigns
+  {"ch",        CTX_ANYWHERE,  {dots("16")}},
+  {"gh",        CTX_ANYWHERE,  {dots("126")}},
+  {"sh",        CTX_ANYWHERE,  {dots("146")}},
+  {"th",        CTX_ANYWHERE,  {dots("1456")}},
+  {"wh",        CTX_ANYWHERE,  {dots("156")}},
+  {"ed",        CTX_ANYWHERE,  {dots("1246")}},
+  {"er",        CTX_ANYWHERE,  {dots("12456")}},
+  {"ou",        CTX_ANYWHERE,  {dots("1256")}},
+  {"ow",        CTX_ANYWHERE,  {dots("246")}},
+  {"st",        CTX_ANYWHERE,  {dots("34")}},
+  {"ar",        CTX_ANYWHERE,  {dots("345")}},
+  {"ing",       CTX_NOT_START, {dots("346")}},
+  {"ble",       CTX_NOT_START, {dots("3456")}},
+
+  //lower wordsigns and groupsigns
+  {"enough",    CTX_WORD,      {dots("26")}},
+  {"were",      CTX_WORD,      {dots("2356")}},
+  {"his",       CTX_WORD,      {dots("236")}},
+  {"was",       CTX_WORD,      {dots("356")}},
+  {"be",        CTX_START,     {dots("23")}},
+  {"con",       CTX_START,     {dots("25")}},
+  {"dis",       CTX_START,     {dots("256")}},
+  {"com",       CTX_START,     {dots("36")}},
+  {"en",        CTX_ANYWHERE,  {dots("26")}},
+  {"in",        CTX_ANYWHERE,  {dots("35")}},
+  {"ea",        CTX_MIDDLE,    {dots("2")}},
+  {"bb",        CTX_MIDDLE,    {dots("23")}},
+  {"cc",        CTX_MIDDLE,    {dots("25")}},
+  {"dd",        CTX_MIDDLE,    {dots("256")}},
+  {"ff",        CTX_MIDDLE,    {dots("235")}},
+  {"gg",        CTX_MIDDLE,    {dots("2356")}},
+
+  //initial-letter contractions
+  {"day",       CTX_ANYWHERE,  {dots("5"), dots("145")}},
+  {"ever",      CTX_ANYWHERE,  {dots("5"), dots("15")}},
+  {"father",    CTX_ANYWHERE,  {dots("5"), dots("124")}},
+  {"here",      CTX_ANYWHERE,  {dots("5"), dots("125")}},
+  {"know",      CTX_ANYWHERE,  {dots("5"), dots("13")}},
+  {"lord",      CTX_ANYWHERE,  {dots("5"), dots("123")}},
+  {"mother",    CTX_ANYWHERE,  {dots("5"), dots("134")}},
+  {"name",      CTX_ANYWHERE,  {dots("5"), dots("1345")}},
+  {"one",       CTX_ANYWHERE,  {dots("5"), dots("135")}},
+  {"part",      CTX_ANYWHERE,  {dots("5"), dots("1234")}},
+  {"question",  CTX_ANYWHERE,  {dots("5"), dots("12345")}},
+  {"right",     CTX_ANYWHERE,  {dots("5"), dots("1235")}},
+  {"some",      CTX_ANYWHERE,  {dots("5"), dots("234")}},
+  {"time",      CTX_ANYWHERE,  {dots("5"), dots("2345")}},
+  {"under",     CTX_ANYWHERE,  {dots("5"), dots("136")}},
+  {"work",      CTX_ANYWHERE,  {dots("5"), dots("2456")}},
+  {"young",     CTX_ANYWHERE,  {dots("5"), dots("13456")}},
+  {"there",     CTX_ANYWHERE,  {dots("5"), dots("2346")}},
+  {"character", CTX_ANYWHERE,  {dots("5"), dots("16")}},
+  {"through",   CTX_ANYWHERE,  {dots("5"), dots("1456")}},
+  {"where",     CTX_ANYWHERE,  {dots("5"), dots("156")}},
+  {"ought",     CTX_ANYWHERE,  {dots("5"), dots("1256")}},
+  {"upon",      CTX_ANYWHERE,  {dots("45"), dots("136")}},
+  {"word",      CTX_ANYWHERE,  {dots("45"), dots("2456")}},
+  {"these",     CTX_ANYWHERE,  {dots("45"), dots("2346")}},
+  {"those",     CTX_ANYWHERE,  {dots("45"), dots("1456")}},
+  {"whose",     CTX_ANYWHERE,  {dots("45"), dots("156")}},
+  {"cannot",    CTX_ANYWHERE,  {dots("456"), dots("14")}},
+  {"had",       CTX_ANYWHERE,  {dots("456"), dots("125")}},
+  {"many",      CTX_ANYWHERE,  {dots("456"), dots("134")}},
+  {"spirit",    CTX_ANYWHERE,  {dots("456"), dots("234")}},
+  {"world",     CTX_ANYWHERE,  {dots("456"), dots("2456")}},
+  {"their",     CTX_ANYWHERE,  {dots("456"), dots("2346")}},
+
+  //final-letter groupsigns
+  {"ound",      CTX_NOT_START, {dots("46"), dots("145")}},
+  {"ance",      CTX_NOT_START, {dots("46"), dots("15")}},
+  {"sion",      CTX_NOT_START, {dots("46"), dots("1345")}},
+  {"less",      CTX_NOT_START, {dots("46"), dots("234")}},
+  {"ount",      CTX_NOT_START, {dots("46"), dots("2345")}},
+  {"ence",      CTX_NOT_START, {dots("56"), dots("15")}},
+  {"ong",       CTX_NOT_START, {dots("56"), dots("1245")}},
+  {"ful",       CTX_NOT_START, {dots("56"), dots("123")}},
+  {"tion",      CTX_NOT_START, {dots("56"), dots("1345")}},
+  {"ness",      CTX_NOT_START, {dots("56"), dots("234")}},
+  {"ment",      CTX_NOT_START, {dots("56"), dots("2345")}},
+  {"ity",       CTX_NOT_START, {dots("56"), dots("13456")}},
+
+  //shortforms
+  {"about",     CTX_WORD,      {dots("1"), dots("12")}},
+  {"above",     CTX_WORD,      {dots("1"), dots("12"), dots("1236")}},
+  {"after",     CTX_WORD,      {dots("1"), dots("124")}},
+  {"again",     CTX_WORD,      {dots("1"), dots("1245")}},
+  {"also",      CTX_WORD,      {dots("1"), dots("123")}},
+  {"almost",    CTX_WORD,      {dots("1"), dots("123"), dots("134")}},
+  {"already",   CTX_WORD,      {dots("1"), dots("123"), dots("1235")}},
+  {"always",    CTX_WORD,      {dots("1"), dots("123"), dots("2456")}},
+  {"braille",   CTX_WORD,      {dots("12"), dots("1235"), dots("123")}},
+  {"could",     CTX_WORD,      {dots("14"), dots("145")}},
+  {"friend",    CTX_WORD,      {dots("124"), dots("1235")}},
+  {"good",      CTX_WORD,      {dots("1245"), dots("145")}},
+  {"great",     CTX_WORD,      {dots("1245"), dots("1235"), dots("2345")}},
+  {"letter",    CTX_WORD,      {dots("123"), dots("1235")}},
+  {"little",    CTX_WORD,      {dots("123"), dots("123")}},
+  {"much",      CTX_WORD,      {dots("134"), dots("16")}},
+  {"must",      CTX_WORD,      {dots("134"), dots("34")}},
+  {"quick",     CTX_WORD,      {dots("12345"), dots("13")}},
+  {"said",      CTX_WORD,      {dots("234"), dots("145")}},
+  {"such",      CTX_WORD,      {dots("234"), dots("16")}},
+  {"today",     CTX_WORD,      {dots("2345"), dots("145")}},
+  {"together",  CTX_WORD,      {dots("2345"), dots("1245"), dots("1235")}},
+  {"tomorrow",  CTX_WORD,      {dots("2345"), dots("134")}},
+  {"tonight",   CTX_WORD,      {dots("2345"), dots("1345")}},
+  {"would",     CTX_WORD,      {dots("2456"), dots("145")}},
+  {"its",       CTX_WORD,      {dots("1346"), dots("234")}},
+  {"your",      CTX_WORD,      {dots("13456"), dots("1235")}},
+  {"children",  CTX_WORD,      {dots("16"), dots("1345")}},
+  {"should",    CTX_WORD,      {dots("146"), dots("145")}}
+};
+
+//---- compile time trie ----
+
+template <size_t N>
+struct Trie {
+  TrieNode node[N];
+  uint16_t used;
+  bool ok; //false if it ran out of nodes or a rule was listed twice
+};
+
+template <size_t N, size_t R>
+constexpr Trie<N> buildTrie(const ContractionRule (&rules)[R]) {
+  Trie<N> t{};
+  t.node[0] = TrieNode{0, 0, 0, -1};
+  t.used = 1;
+  t.ok = true;
+
+  for (size_t r = 0; r < R; r++) {
+    uint16_t cur = 0;
+    for (const char *p = rules[r].text; *p; p++) {
+      uint16_t prev = 0;
+      uint16_t next = t.node[cur].child;
+      while (next && t.node[next].ch < *p) {
+        prev = next;
+        next = t.node[next].sibling;
+      }
+      if (!next || t.node[next].ch != *p) {
+        if (t.used == N) {
+          t.ok = false;
+          return t;
+        }
+        uint16_t added = t.used++;
+        t.node[added] = TrieNode{*p, 0, next, -1};
+        if (prev) t.node[prev].sibling = added;
+        else t.node[cur].child = added;
+        next = added;
+      }
+      cur = next;
+    }
+    if (t.node[cur].rule >= 0) t.ok = false;
+    t.node[cur].rule = (int16_t)r;
+  }
+  return t;
+}
+
+template <size_t R>
+constexpr size_t totalLetters(const ContractionRule (&rules)[R]) {
+  size_t n = 1;
+  for (size_t r = 0; r < R; r++) {
+    for (const char *p = rules[r].text; *p; p++) n++;
+  }
+  return n;
+}
+
+//first pass with room for every letter finds the real node count, second builds it at that size
+static constexpr uint16_t UEB_NODES = buildTrie<totalLetters(UEB_RULES)>(UEB_RULES).used;
+static constexpr Trie<UEB_NODES> UEB_TRIE = buildTrie<UEB_NODES>(UEB_RULES);
+static_assert(UEB_TRIE.ok, "UEB_RULES has a duplicate rule");
+
+const ContractionTable UEB_CONTRACTIONS = {UEB_TRIE.node, UEB_RULES};
+
+//---- translation ----
+
+static const size_t MAX_WORD = 32; //longer words are spelled out
+
+static bool isUpper(char c) { return c >= 'A' && c <= 'Z'; }
+static bool isLetter(char c) { return isUpper(c) || (c >= 'a' && c <= 'z'); }
+
+static bool contextAllows(uint8_t context, size_t start, size_t end, size_t wordLen) {
+  switch (context) {
+    case CTX_WORD:      return start == 0 && end == wordLen;
+    case CTX_START:     return start == 0;
+    case CTX_MIDDLE:    return start > 0 && end < wordLen;
+    case CTX_NOT_START: return start > 0;
+    default:            return true;
+  }
+}
+
+//longest rule matching word[pos..] that is allowed there, -1 if none
+static int16_t longestMatch(const ContractionTable &table, const char *word, size_t len, size_t pos,
+                            size_t &matchLen) {
+  int16_t best = -1;
+  uint16_t node = table.nodes[0].child;
+
+  for (size_t j = pos; node && j < len; j++) {
+    while (node && table.nodes[node].ch < word[j]) node = table.nodes[node].sibling;
+    if (!node || table.nodes[node].ch != word[j]) break;
+
+    int16_t r = table.nodes[node].rule;
+    if (r >= 0 && contextAllows(table.rules[r].context, pos, j + 1, len)) {
+      best = r;
+      matchLen = j + 1 - pos;
+    }
+    node = table.nodes[node].child;
+  }
+  return best;
+}
+
+//contracts one word of letters into out, returns the cell count or 0 if it has to be spelled out
+static size_t contractWord(const ContractionTable &table, const char *text, size_t len, bool afterDigit,
+                           uint8_t *out) {
+  char word[MAX_WORD];
+  size_t upper = 0;
+  size_t n = 0;
+
+  if (len == 0 || len > MAX_WORD) return 0;
+  for (size_t i = 0; i < len; i++) {
+    if (isUpper(text[i])) upper++;
+    word[i] = text[i] | 0x20;
+  }
+
+  if (upper == len && len > 1) {
+    out[n++] = CAPITAL_SIGN;
+    out[n++] = CAPITAL_SIGN;
+  } else if (upper == 1 && isUpper(text[0])) {
+    out[n++] = CAPITAL_SIGN;
+  } else if (upper) {
+    return 0; //mixed case like "iPhone", leave it to grade 1
+  }
+
+  //a letter on its own or a-j after a number would be read as a wordsign or a digit
+  bool wordsignLetter = len == 1 && word[0] != 'a' && word[0] != 'i' && word[0] != 'o';
+  if (wordsignLetter || (afterDigit && !upper && word[0] <= 'j')) out[n++] = GRADE1_SIGN;
+
+  for (size_t i = 0; i < len;) {
+    size_t matchLen = 0;
+    int16_t r = longestMatch(table, word, len, i, matchLen);
+    if (r < 0) {
+      out[n++] = brailleCell(word[i]);
+      i++;
+      continue;
+    }
+    for (size_t k = 0; k < 3 && table.rules[r].cells[k]; k++) {
+      out[n++] = table.rules[r].cells[k];
+    }
+    i += matchLen;
+  }
+  return n;
+}
+
+size_t translateContracted(const ContractionTable &table, const char *text, size_t len,
+                           uint8_t *cells, size_t maxCells) {
+  size_t n = 0;
+  size_t i = 0;
+
+  while (i < len) {
+    size_t end = i;
+    if (!isLetter(text[i])) {
+      //numbers, spaces and punctuation up to the next word
+      while (end < len && !isLetter(text[end])) end++;
+
+      size_t consumed = 0;
+      n += translateText(text + i, end - i, cells + n, maxCells - n, &consumed);
+      if (consumed < end - i) break;
+    } else {
+      while (end < len && isLetter(text[end])) end++;
+
+      uint8_t word[MAX_WORD + 3];
+      size_t count = contractWord(table, text + i, end - i, i > 0 && text[i - 1] >= '0' && text[i - 1] <= '9', word);
+      if (count == 0) {
+        size_t consumed = 0;
+        n += translateText(text + i, end - i, cells + n, maxCells - n, &consumed);
+        if (consumed < end - i) break;
+      } else {
+        size_t fit = count < maxCells - n ? count : maxCells - n;
+        for (size_t k = 0; k < fit; k++) {
+          cells[n++] = word[k];
+        }
+        if (fit < count) break;
+      }
+    }
+    i = end;
+  }
+
+  return n;
+}
+
+size_t translateWith(uint8_t table, const char *text, size_t len, uint8_t *cells, size_t maxCells) {
+  switch (table) {
+    case TABLE_UEB_GRADE2: return translateContracted(UEB_CONTRACTIONS, text, len, cells, maxCells);
+    case TABLE_COMPUTER: return translateComputer(text, len, cells, maxCells);
+    default: return translateText(text, len, cells, maxCells);
+  }
+}
@@ -0,0 +1,35 @@
+#include "CpuLoad.h"
+#include <esp_freertos_hooks.h>
+
+constexpr uint8_t CORES = 2;
+
+//each core only writes its own counters
+static volatile uint32_t ticks[CORES];
+static volatile uint32_t idleTicks[CORES];
+static uint32_t lastTicks[CORES];
+static uint32_t lastIdle[CORES];
+
+static inline void sample(uint8_t core) {
+  ticks[core]++;
+  if (xTaskGetCurrentTaskHandleForCPU(core) == xTaskGetIdleTaskHandleForCPU(core)) idleTicks[core]++;
+}
+
+static void IRAM_ATTR onTick0() { sample(0); }
+static void IRAM_ATTR onTick1() { sample(1); }
+
+void cpuLoadBegin() {
+  esp_register_freertos_tick_hook_for_cpu(onTick0, 0);
+  esp_register_freertos_tick_hook_for_cpu(onTick1, 1);
+}
+
+void cpuLoadPrint(Print &out) {
+  for (uint8_t core = 0; core < CORES; core++) {
+    uint32_t total = ticks[core] - lastTicks[core];
+    uint32_t idle = idleTicks[core] - lastIdle[core];
+    lastTicks[core] += total;
+    lastIdle[core] += idle;
+    uint32_t busy = total ? (uint64_t)(total - idle) * 1000 / total : 0;
+    out.printf("cpu%u %u.%u%% ", core, (unsigned)(busy / 10), (unsigned)(busy % 10));
+  }
+  out.printf("\n");
+}
@@ -0,0 +1,346 @@
+#include "DeviceList.h"
+#include <string.h>
+#include <stdio.h>
+#include "Hash.h"
+#include "WireFormat.h"
+
+bool DeviceListParser::begin(DeviceList &list, size_t total) {
+  _list = &list;
+  list.length = 0;
+  list.count = 0;
+  list.rooms = 0;
+  _received = 0;
+  _scanned = 0;
+  _tokenStart = 0;
+  _inRoom = true;
+  _roomHasDevices = false;
+  _ok = total <= DEVICE_LIST_BYTES;
+  _total = _ok ? total : 0;
+  return _ok;
+}
+
+bool DeviceListParser::feed(const char *chunk, size_t len) {
+  if (!_ok) return false;
+  if (len > (size_t)(_total - _received)) return _ok = false;
+
+  char *dest = _list->text + _received;
+  if (chunk != dest) memcpy(dest, chunk, len); //parseDeviceList() hands in text itself
+  _received += len;
+  _list->length = _received;
+  scan();
+  return _ok;
+}
+
+void DeviceListParser::scan() {
+  const char *text = _list->text;
+  for (uint16_t i = _scanned; i < _received && _ok; i++) {
+    char c = text[i];
+    if (_inRoom) {
+      if (c == '-') {
+        _room = {_tokenStart, (uint16_t)(i - _tokenStart)};
+        _inRoom = false;
+        _roomHasDevices = false;
+        _tokenStart = i + 1;
+      } else if (c == ',') {
+        _tokenStart = i + 1; //a room without devices, nothing to show
+      } else if (c == ';') {
+        _ok = false; //device separator before the room name ended
+      }
+    } else if (c == ';' || c == ',') {
+      addDevice(i);
+      _tokenStart = i + 1;
+      if (c == ',') _inRoom = true;
+    }
+  }
+  _scanned = _received;
+}
+
+void DeviceListParser::addDevice(uint16_t end) {
+  if (end == _tokenStart) return; //empty name, as in "dev;;dev"
+  if (_list->count == DEVICE_LIST_ENTRIES) {
+    _ok = false;
+    return;
+  }
+  if (!_roomHasDevices) {
+    _list->rooms++;
+    _roomHasDevices = true;
+  }
+  _list->entry[_list->count++] = {_room, {_tokenStart, (uint16_t)(end - _tokenStart)}, STATUS_UNKNOWN, STATUS_UNKNOWN};
+}
+
+bool DeviceListParser::finish() {
+  if (_ok && _received != _total) _ok = false;
+  if (_ok && !_inRoom) addDevice(_received);
+  //the backend answers "ERROR: <message>" when it can't read the database
+  if (_ok && _received >= 6 && memcmp(_list->text, "ERROR:", 6) == 0) _ok = false;
+  if (_ok) {
+    _list->hash = fnv1a(_list->text, _received);
+  } else if (_list != nullptr) {
+    _list->count = 0;
+    _list->rooms = 0;
+    _list->hash = 0;
+  }
+  return _ok;
+}
+
+//what the menu shows, the names in entry order: status bytes and room names nobody uses any
+//more don't change it
+static uint32_t namesHash(const DeviceList &list) {
+  uint32_t hash = FNV_OFFSET;
+  for (uint16_t i = 0; i < list.count; i++) {
+    const DeviceEntry &e = list.entry[i];
+    hash = fnv1a(&e.room.len, sizeof(e.room.len), hash);
+    hash = fnv1a(list.at(e.room), e.room.len, hash);
+    hash = fnv1a(&e.device.len, sizeof(e.device.len), hash);
+    hash = fnv1a(list.at(e.device), e.device.len, hash);
+  }
+  return hash;
+}
+
+//A binary snapshot, in one pass with every length checked against what is left. The entries
+//point at the names where they are in text, like for the text payload.
+static bool decodeDeviceList(DeviceList &list) {
+  const uint8_t *text = (const uint8_t *)list.text;
+  WireReader r(text, list.length);
+  WireHeader h;
+  if (!readWireHeader(r, h) || h.kind != WIRE_SNAPSHOT) return false;
+  if (h.records > DEVICE_LIST_ENTRIES) return false;
+
+  for (uint16_t i = 0; i < h.rooms; i++) {
+    const uint8_t *s;
+    uint8_t len;
+    if (!r.name(s, len)) return false;
+    TextView room = {(uint16_t)(s - text), len};
+    uint8_t count = r.u8();
+    if (!r.ok() || count > h.records - list.count) return false;
+    if (count > 0) list.rooms++;
+    for (uint8_t d = 0; d < count; d++) {
+      uint8_t status = r.u8();
+      uint8_t battery = r.u8();
+      if (!r.name(s, len)) return false;
+      list.entry[list.count++] = {room, {(uint16_t)(s - text), len}, status, battery};
+    }
+  }
+  if (list.count != h.records || !r.done()) return false;
+
+  list.epoch = h.epoch;
+  list.version = h.version;
+  list.hash = namesHash(list);
+  return true;
+}
+
+bool parseDeviceList(DeviceList &list) {
+  if (isWireMessage(list.text, list.length)) {
+    list.count = 0;
+    list.rooms = 0;
+    if (decodeDeviceList(list)) return true;
+    list.count = 0;
+    list.rooms = 0;
+    list.hash = 0;
+    return false;
+  }
+  DeviceListParser parser;
+  uint16_t len = list.length;
+  if (parser.begin(list, len)) parser.feed(list.text, len);
+  return parser.finish();
+}
+
+//a room and device name in a delta, they point into the delta
+struct WireName {
+  const uint8_t *room;
+  uint8_t roomLen;
+  const uint8_t *device;
+  uint8_t deviceLen;
+};
+
+static bool sameText(const DeviceList &list, TextView view, const uint8_t *text, size_t len) {
+  return view.len == len && memcmp(list.at(view), text, len) == 0;
+}
+
+//entry of room/device, -1 if there is none
+static int findEntry(const DeviceList &list, const WireName &name) {
+  for (uint16_t i = 0; i < list.count; i++) {
+    const DeviceEntry &e = list.entry[i];
+    if (sameText(list, e.room, name.room, name.roomLen) &&
+        sameText(list, e.device, name.device, name.deviceLen)) return i;
+  }
+  return -1;
+}
+
+static uint8_t *bytes(DeviceList &list) {
+  return (uint8_t *)list.text;
+}
+
+static void putU16(uint8_t *p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+static void putU32(uint8_t *p, uint32_t v) {
+  putU16(p, v);
+  putU16(p + 2, v >> 16);
+}
+
+//header fields changed in place
+constexpr size_t AT_VERSION = 8;
+constexpr size_t AT_ROOMS = 16;
+constexpr size_t AT_RECORDS = 18;
+
+//Replaces remove bytes at at with insert, sets the header count at countAt (if not 0) to count and
+//decodes the snapshot again. Nothing is touched if the result wouldn't fit, so the list stays a
+//whole snapshot either way.
+static bool splice(DeviceList &list, uint16_t at, uint16_t remove, const uint8_t *insert, size_t len,
+                   size_t countAt = 0, uint16_t count = 0) {
+  if (list.length - remove + len > DEVICE_LIST_BYTES) return false;
+  if (countAt != 0) putU16(bytes(list) + countAt, count);
+  memmove(list.text + at + len, list.text + at + remove, list.length - at - remove);
+  if (len > 0) memcpy(list.text + at, insert, len);
+  list.length = list.length - remove + len;
+  return parseDeviceList(list);
+}
+
+//the header's and the room's counts change with the bytes, so the list is a whole snapshot again
+//after each splice
+static bool removeDevice(DeviceList &list, int i) {
+  const DeviceEntry &e = list.entry[i];
+  uint8_t &count = bytes(list)[e.room.offset + e.room.len]; //in front of the record, it doesn't move
+  uint16_t end = e.device.offset + e.device.len;
+  uint16_t at = e.device.offset - WIRE_RECORD;
+  if (--count == 0) {
+    //the room's last device, its name goes with it; shrinking always fits
+    at = e.room.offset - 1;
+    putU16(bytes(list) + AT_ROOMS, (bytes(list)[AT_ROOMS] | bytes(list)[AT_ROOMS + 1] << 8) - 1);
+  }
+  return splice(list, at, end - at, nullptr, 0, AT_RECORDS, list.count - 1);
+}
+
+static bool insertDevice(DeviceList &list, const WireName &name, uint8_t status, uint8_t battery) {
+  WireReader r(bytes(list), list.length);
+  WireHeader h;
+  if (!readWireHeader(r, h) || list.count == DEVICE_LIST_ENTRIES) return false;
+
+  //after the last device of the room, or a new room at the end
+  uint16_t countAt = 0;
+  uint16_t at = list.length;
+  for (uint16_t i = 0; i < h.rooms && countAt == 0; i++) {
+    const uint8_t *s;
+    uint8_t len;
+    bool found = r.name(s, len) && len == name.roomLen && memcmp(s, name.room, len) == 0;
+    uint16_t countByte = r.at() - bytes(list);
+    uint8_t count = r.u8();
+    for (uint8_t d = 0; d < count; d++) {
+      r.u8();
+      r.u8();
+      r.name(s, len);
+    }
+    if (!r.ok()) return false;
+    if (found) {
+      countAt = countByte;
+      at = r.at() - bytes(list);
+    }
+  }
+
+  uint8_t token[2 + 255 + WIRE_RECORD + 255];
+  size_t len = 0;
+  if (countAt == 0) {
+    if (h.rooms == 0xFFFF) return false;
+    token[len++] = name.roomLen;
+    memcpy(token + len, name.room, name.roomLen);
+    len += name.roomLen;
+    token[len++] = 1;
+  } else if (bytes(list)[countAt] == 255) {
+    return false;
+  }
+  token[len++] = status;
+  token[len++] = battery;
+  token[len++] = name.deviceLen;
+  memcpy(token + len, name.device, name.deviceLen);
+  len += name.deviceLen;
+
+  //the counts are only written once the bytes are known to fit
+  if (list.length + len > DEVICE_LIST_BYTES) return false;
+  if (countAt == 0) putU16(bytes(list) + AT_ROOMS, h.rooms + 1);
+  else bytes(list)[countAt]++;
+  return splice(list, at, 0, token, len, AT_RECORDS, list.count + 1);
+}
+
+static bool readName(WireReader &r, WireName &name) {
+  return r.name(name.room, name.roomLen) && r.name(name.device, name.deviceLen);
+}
+
+static bool applyRecord(DeviceList &list, WireReader &r) {
+  WireName from, to;
+  uint8_t op = r.u8();
+  if (!readName(r, from)) return false;
+
+  switch (op) {
+    case WIRE_ADD: {
+      uint8_t status = r.u8();
+      uint8_t battery = r.u8();
+      return r.ok() && insertDevice(list, from, status, battery);
+    }
+    case WIRE_REMOVE: {
+      int i = findEntry(list, from);
+      return i >= 0 && removeDevice(list, i);
+    }
+    case WIRE_MOVE: {
+      int i = findEntry(list, from);
+      if (i < 0 || !readName(r, to)) return false;
+      const DeviceEntry e = list.entry[i];
+      if (!sameText(list, e.room, to.room, to.roomLen)) {
+        return removeDevice(list, i) && insertDevice(list, to, e.status, e.battery);
+      }
+      //renamed in its room, it keeps its place
+      uint8_t token[256];
+      token[0] = to.deviceLen;
+      memcpy(token + 1, to.device, to.deviceLen);
+      return splice(list, e.device.offset - 1, e.device.len + 1, token, to.deviceLen + 1);
+    }
+    case WIRE_STATUS: {
+      //fixed width, written over the old bytes without moving anything
+      int i = findEntry(list, from);
+      uint8_t status = r.u8();
+      uint8_t battery = r.u8();
+      if (i < 0 || !r.ok()) return false;
+      DeviceEntry &e = list.entry[i];
+      e.status = status;
+      e.battery = battery;
+      bytes(list)[e.device.offset - 3] = status;
+      bytes(list)[e.device.offset - 2] = battery;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool applyDeviceDelta(DeviceList &list, const char *delta, size_t len) {
+  WireReader r((const uint8_t *)delta, len);
+  WireHeader h;
+  if (!readWireHeader(r, h) || h.kind != WIRE_DELTA) return false;
+  if (!isWireMessage(list.text, list.length)) return false;
+  if (list.epoch == 0 || h.epoch != list.epoch || h.base != list.version) return false;
+
+  for (uint16_t i = 0; i < h.records; i++) {
+    if (!applyRecord(list, r)) {
+      list.epoch = 0;
+      list.version = 0;
+      return false;
+    }
+  }
+  list.version = h.version;
+  putU32(bytes(list) + AT_VERSION, h.version);
+  return true;
+}
+
+void copyDeviceStatus(DeviceList &list, const DeviceList &from) {
+  if (list.count != from.count) return;
+  bool binary = isWireMessage(list.text, list.length);
+  for (uint16_t i = 0; i < list.count; i++) {
+    DeviceEntry &e = list.entry[i];
+    e.status = from.entry[i].status;
+    e.battery = from.entry[i].battery;
+    if (!binary) continue;
+    bytes(list)[e.device.offset - 3] = e.status;
+    bytes(list)[e.device.offset - 2] = e.battery;
+  }
+}
@@ -0,0 +1,37 @@
+#include "LatencyHistogram.h"
+
+void LatencyHistogram::record(uint32_t us) {
+  uint8_t i = us == 0 ? 0 : 32 - __builtin_clz(us);
+  if (i >= BUCKETS) i = BUCKETS - 1;
+  _bucket[i]++;
+  _count++;
+  if (us > _max) _max = us;
+}
+
+void LatencyHistogram::reset() {
+  for (uint8_t i = 0; i < BUCKETS; i++) {
+    _bucket[i] = 0;
+  }
+  _count = 0;
+  _max = 0;
+}
+
+uint32_t LatencyHistogram::percentile(uint8_t p) const {
+  if (_count == 0) return 0;
+  uint32_t wanted = ((uint64_t)_count * p + 99) / 100;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < BUCKETS; i++) {
+    seen += _bucket[i];
+    if (seen >= wanted && seen > 0) return i == BUCKETS - 1 || bucketLimit(i) > _max ? _max : bucketLimit(i);
+  }
+  return _max;
+}
+
+void LatencyHistogram::print(Print &out, const char *name) const {
+  out.printf("%s: n=%u p50<=%uus p99<=%uus max=%uus\n", name, (unsigned)_count,
+             (unsigned)percentile(50), (unsigned)percentile(99), (unsigned)_max);
+  for (uint8_t i = 0; i < BUCKETS; i++) {
+    if (_bucket[i] == 0) continue;
+    out.printf("  <=%8uus %u\n", (unsigned)bucketLimit(i), (unsigned)_bucket[i]);
+  }
+}
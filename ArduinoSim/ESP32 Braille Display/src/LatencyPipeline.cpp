@@ -0,0 +1,69 @@
+#include "LatencyPipeline.h"
+
+static const char *const SOURCE_NAMES[LATENCY_SOURCE_COUNT] = {"button", "mqtt"};
+//segment names, a segment ends at the stage of the same index
+static const char *const SEGMENT_NAMES[STAGE_COUNT] = {"total", "dispatch", "translate", "buffer", "spi"};
+
+void LatencyPipeline::start(LatencySource source, uint32_t edgeMicros) {
+  _source = source;
+  _at[STAGE_EDGE] = edgeMicros;
+  _at[STAGE_DISPATCH] = micros();
+  _stamped = bit(STAGE_EDGE) | bit(STAGE_DISPATCH);
+  _open = true;
+}
+
+void LatencyPipeline::stamp(LatencyStage stage, uint32_t at) {
+  if (!_open) return;
+  _at[stage] = at;
+  _stamped |= bit(stage);
+}
+
+void LatencyPipeline::finish() {
+  if (!_open) return;
+  _open = false;
+  if (_stamped != bit(STAGE_COUNT) - 1) return;
+
+  LatencyHistogram *hist = _hist[_source];
+  hist[0].record(_at[STAGE_SPI] - _at[STAGE_EDGE]);
+  for (uint8_t s = 1; s < STAGE_COUNT; s++) {
+    hist[s].record(_at[s] - _at[s - 1]);
+  }
+}
+
+void LatencyPipeline::reset() {
+  for (auto &source : _hist) {
+    for (auto &hist : source) hist.reset();
+  }
+}
+
+void LatencyPipeline::print(Print &out) const {
+  char name[24];
+  for (uint8_t src = 0; src < LATENCY_SOURCE_COUNT; src++) {
+    if (_hist[src][0].count() == 0) continue;
+    for (uint8_t s = 0; s < STAGE_COUNT; s++) {
+      snprintf(name, sizeof(name), "%s %s", SOURCE_NAMES[src], SEGMENT_NAMES[s]);
+      _hist[src][s].print(out, name);
+    }
+  }
+}
+
+size_t LatencyPipeline::formatJson(char *buf, size_t size) const {
+  size_t len = 0;
+  auto append = [&](const char *format, auto... args) {
+    if (len < size) len += snprintf(buf + len, size - len, format, args...);
+  };
+
+  append("{");
+  for (uint8_t src = 0; src < LATENCY_SOURCE_COUNT; src++) {
+    append("%s\"%s\":{", src ? "," : "", SOURCE_NAMES[src]);
+    for (uint8_t s = 0; s < STAGE_COUNT; s++) {
+      const LatencyHistogram &h = _hist[src][s];
+      append("%s\"%s\":{\"n\":%u,\"p50\":%u,\"p99\":%u,\"max\":%u}", s ? "," : "", SEGMENT_NAMES[s],
+             (unsigned)h.count(), (unsigned)h.percentile(50), (unsigned)h.percentile(99),
+             (unsigned)h.max());
+    }
+    append("}");
+  }
+  append("}");
+  return len < size ? len : 0; //0 if it didn't fit
+}
@@ -0,0 +1,104 @@
+#include "LineRenderer.h"
+#include <string.h>
+
+static_assert(MAX_LINE_CELLS <= 64, "LineRenderer keeps a bit per cell in a uint64_t");
+
+uint8_t LineRenderer::commit(const uint8_t cells[], uint8_t count) {
+  const uint8_t lineCells = _geometry.cells;
+  if (count > lineCells) count = lineCells;
+  _commits++;
+  for (uint8_t i = 0; i < lineCells; i++) _text[i] = i < count ? cells[i] : 0;
+  return draw();
+}
+
+void LineRenderer::setOverlay(uint8_t cell, uint8_t dots, uint16_t periodMs, uint16_t phaseMs) {
+  if (cell >= _geometry.cells) return;
+  _overlay[cell] = {dots, periodMs, phaseMs};
+  _dark &= ~(1ULL << cell); //starts on, refresh() puts it in phase
+}
+
+void LineRenderer::clearOverlay() {
+  memset(_overlay, 0, sizeof(_overlay));
+  _dark = 0;
+}
+
+uint8_t LineRenderer::refresh(uint32_t nowMs) {
+  uint64_t dark = 0;
+  for (uint8_t i = 0; i < _geometry.cells; i++) {
+    const OverlayCell &o = _overlay[i];
+    if (o.dots != 0 && o.periodMs != 0 && (nowMs + o.phaseMs) / o.periodMs % 2 == 1) dark |= 1ULL << i;
+  }
+  _dark = dark;
+  return draw();
+}
+
+uint32_t LineRenderer::untilNextPhase(uint32_t nowMs) const {
+  uint32_t next = 0;
+  for (uint8_t i = 0; i < _geometry.cells; i++) {
+    const OverlayCell &o = _overlay[i];
+    if (o.dots == 0 || o.periodMs == 0) continue;
+    uint32_t wait = o.periodMs - (nowMs + o.phaseMs) % o.periodMs;
+    if (next == 0 || wait < next) next = wait;
+  }
+  return next;
+}
+
+//composites the text and overlay planes and sends what differs from the LEDs
+uint8_t LineRenderer::draw() {
+  const uint8_t lineCells = _geometry.cells;
+  uint8_t cells[MAX_LINE_CELLS];
+  for (uint8_t i = 0; i < lineCells; i++) {
+    cells[i] = _text[i] | ((_dark >> i & 1) ? 0 : _overlay[i].dots);
+  }
+
+  if (!_valid) {
+    blitCells(_matrix, _geometry, cells, lineCells);
+    _bufferedAt = _sentAt = micros();
+    memcpy(_shown, cells, lineCells);
+    _valid = true;
+    _cellsRewritten += lineCells;
+    return lineCells;
+  }
+
+  uint8_t set[MAX_LINE_DEVICES][ROW_SIZE];
+  uint8_t clr[MAX_LINE_DEVICES][ROW_SIZE];
+  memset(set, 0, _geometry.devices * ROW_SIZE);
+  memset(clr, 0, _geometry.devices * ROW_SIZE);
+  uint8_t changed = 0;
+
+  for (uint8_t i = 0; i < lineCells; i++) {
+    uint8_t cell = cells[i];
+    uint8_t diff = _shown[i] ^ cell;
+    if (diff == 0) continue;
+
+    changed++;
+    _shown[i] = cell;
+    for (uint8_t d = 0; d < 8; d++) {
+      if (!bitRead(diff, d)) continue;
+      const DotTarget &t = _geometry.cell[i].dot[d];
+      if (bitRead(cell, d)) set[t.device][t.digit] |= t.mask;
+      else clr[t.device][t.digit] |= t.mask;
+    }
+  }
+  if (changed == 0) {
+    _bufferedAt = _sentAt = micros();
+    return 0;
+  }
+
+  //the commit sends one transaction per digit row that changed on any device
+  {
+    MD_MAX72XX::Frame frame(_matrix);
+    for (uint8_t dev = 0; dev < _geometry.devices; dev++) {
+      for (uint8_t dig = 0; dig < ROW_SIZE; dig++) {
+        if ((set[dev][dig] | clr[dev][dig]) == 0) continue;
+        uint8_t old = _matrix.getRow(dev, dig);
+        _matrix.setRow(dev, dig, (old & ~clr[dev][dig]) | set[dev][dig]);
+      }
+    }
+    _bufferedAt = micros();
+  } //spiSend() is synchronous
+  _sentAt = micros();
+
+  _cellsRewritten += changed;
+  return changed;
+}
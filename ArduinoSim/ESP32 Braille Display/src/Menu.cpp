@@ -0,0 +1,139 @@
+#include "Menu.h"
+#include <string.h>
+
+static const char *const ACTION_NAMES[ACTION_COUNT] = {"on", "off"};
+
+uint16_t Menu::translate(const char *text, size_t len, uint8_t table, uint8_t &length) {
+  size_t room = MENU_CELLS - _cellsUsed;
+  if (room > 255) room = 255; //MenuNode::length is a byte
+  uint16_t offset = _cellsUsed;
+  uint8_t *cells = _cells + offset;
+  //one cell more than there is room for, the arena's spare cell at worst: a name that needs it
+  //would show cut off, one that fits exactly is whole
+  size_t n = _strips.translate(table, text, len, cells, room < 255 ? room + 1 : room);
+  if (n > room) {
+    _full = true;
+    n = 0;
+  }
+  _cellsUsed += n;
+  length = n;
+  return offset;
+}
+
+uint16_t Menu::addNode(uint16_t parent, uint16_t prev, uint8_t kind, uint16_t item,
+                       uint16_t cells, uint8_t length) {
+  uint16_t i = _count++;
+  _node[i] = {parent, NO_NODE, NO_NODE, prev, cells, length, kind, item};
+  if (prev != NO_NODE) {
+    _node[prev].next = i;
+  } else if (parent != NO_NODE) {
+    _node[parent].firstChild = i;
+  }
+  return i;
+}
+
+bool Menu::build(const DeviceList &list, uint8_t table) {
+  _count = 0;
+  _cellsUsed = 0;
+  _full = false;
+  _list = &list;
+
+  uint8_t length;
+  uint16_t cells = translate("no devices", 10, table, length);
+  uint16_t root = addNode(NO_NODE, NO_NODE, MENU_ROOT, 0, cells, length);
+
+  //the action names are the same under every device, translated once and shared
+  uint16_t actionCells[ACTION_COUNT];
+  uint8_t actionLength[ACTION_COUNT];
+  for (uint8_t a = 0; a < ACTION_COUNT; a++) {
+    actionCells[a] = translate(ACTION_NAMES[a], strlen(ACTION_NAMES[a]), table, actionLength[a]);
+  }
+
+  uint16_t room = NO_NODE;
+  uint16_t device = NO_NODE;
+  for (uint16_t i = 0; i < list.count; i++) {
+    const DeviceEntry &e = list.entry[i];
+
+    //entries of a room are next to each other and share its view
+    if (room == NO_NODE || e.room.offset != list.entry[i - 1].room.offset) {
+      cells = translate(list.at(e.room), e.room.len, table, length);
+      room = addNode(root, room, MENU_ROOM, i, cells, length);
+      device = NO_NODE;
+    }
+
+    cells = translate(list.at(e.device), e.device.len, table, length);
+    device = addNode(room, device, MENU_DEVICE, i, cells, length);
+
+    uint16_t action = NO_NODE;
+    for (uint8_t a = 0; a < ACTION_COUNT; a++) {
+      action = addNode(device, action, MENU_ACTION, a, actionCells[a], actionLength[a]);
+    }
+  }
+
+  _current = _node[root].firstChild != NO_NODE ? _node[root].firstChild : root;
+  return !_full;
+}
+
+bool Menu::restore(const DeviceList &list, uint16_t nodes, uint16_t cells) {
+  _count = 0;
+  _cellsUsed = 0;
+  _full = false;
+  _list = &list;
+  if (nodes == 0 || nodes > MENU_NODES || cells > MENU_CELLS || _node[0].kind != MENU_ROOT) return false;
+
+  auto link = [nodes](uint16_t i) { return i == NO_NODE || i < nodes; };
+  for (uint16_t i = 0; i < nodes; i++) {
+    const MenuNode &n = _node[i];
+    if (!link(n.parent) || !link(n.firstChild) || !link(n.next) || !link(n.prev)) return false;
+    if (n.cells + n.length > cells || n.kind > MENU_ACTION) return false;
+    if ((n.kind == MENU_ROOM || n.kind == MENU_DEVICE) && n.item >= list.count) return false;
+    if (n.kind == MENU_ACTION && n.item >= ACTION_COUNT) return false;
+  }
+
+  _count = nodes;
+  _cellsUsed = cells;
+  _current = _node[0].firstChild != NO_NODE ? _node[0].firstChild : 0;
+  return true;
+}
+
+bool Menu::select(uint16_t index) {
+  if (index >= _count || index == 0) return false;
+  _current = index;
+  return true;
+}
+
+uint16_t Menu::find(uint8_t kind, const uint8_t *cells, uint8_t length) const {
+  for (uint16_t i = 1; i < _count; i++) {
+    const MenuNode &n = _node[i];
+    if (n.kind == kind && n.length == length && memcmp(_cells + n.cells, cells, length) == 0) return i;
+  }
+  return NO_NODE;
+}
+
+bool Menu::next() {
+  uint16_t to = _node[_current].next;
+  if (to == NO_NODE) return false;
+  _current = to;
+  return true;
+}
+
+bool Menu::prev() {
+  uint16_t to = _node[_current].prev;
+  if (to == NO_NODE) return false;
+  _current = to;
+  return true;
+}
+
+bool Menu::enter() {
+  uint16_t to = _node[_current].firstChild;
+  if (to == NO_NODE) return false;
+  _current = to;
+  return true;
+}
+
+bool Menu::back() {
+  uint16_t to = _node[_current].parent;
+  if (to == NO_NODE || _node[to].kind == MENU_ROOT) return false;
+  _current = to;
+  return true;
+}
@@ -0,0 +1,93 @@
+#include "MenuCache.h"
+#include <LittleFS.h>
+#include "Hash.h"
+
+#define CACHE_FILE "/menu.bin"
+#define CACHE_TEMP "/menu.tmp" //written first and renamed, a reset halfway leaves the old cache
+
+constexpr uint32_t CACHE_MAGIC = 0x434D4C42; //"BLMC"
+//bump whenever DeviceList, MenuNode or the braille tables change, old caches are ignored then
+constexpr uint16_t CACHE_FORMAT = 4;
+
+//followed by the list's text, the menu's nodes and its cells
+struct CacheHeader {
+  uint32_t magic;
+  uint16_t format;
+  uint8_t table; //TranslationTable
+  uint8_t nodeSize;
+  uint32_t hash;
+  uint32_t epoch;
+  uint32_t version;
+  uint16_t textLength;
+  uint16_t nodes;
+  uint16_t cells;
+  uint16_t reserved;
+  uint32_t checksum; //of everything after the header
+};
+
+static bool mounted = false;
+
+static bool readBlock(File &f, void *data, size_t len) {
+  return f.read((uint8_t *)data, len) == len;
+}
+
+static bool writeBlock(File &f, const void *data, size_t len) {
+  return f.write((const uint8_t *)data, len) == len;
+}
+
+bool menuCacheBegin() {
+  mounted = LittleFS.begin(true);
+  return mounted;
+}
+
+bool menuCacheLoad(DeviceList &list, Menu &menu, uint8_t &table) {
+  if (!mounted) return false;
+  File f = LittleFS.open(CACHE_FILE, "r");
+  if (!f) return false;
+
+  CacheHeader h;
+  bool ok = readBlock(f, &h, sizeof(h)) && h.magic == CACHE_MAGIC && h.format == CACHE_FORMAT && h.table < TABLE_COUNT &&
+            h.nodeSize == sizeof(MenuNode) && h.textLength <= DEVICE_LIST_BYTES &&
+            h.nodes <= MENU_NODES && h.cells <= MENU_CELLS &&
+            readBlock(f, list.text, h.textLength) &&
+            readBlock(f, menu.nodeBuffer(), h.nodes * sizeof(MenuNode)) &&
+            readBlock(f, menu.cellBuffer(), h.cells);
+  f.close();
+  if (!ok) return false;
+
+  uint32_t sum = fnv1a(list.text, h.textLength);
+  sum = fnv1a(menu.nodeBuffer(), h.nodes * sizeof(MenuNode), sum);
+  sum = fnv1a(menu.cellBuffer(), h.cells, sum);
+  if (sum != h.checksum) return false;
+
+  //the entries aren't stored, parsing the text again is quicker than reading them
+  list.length = h.textLength;
+  if (!parseDeviceList(list) || list.hash != h.hash) return false;
+  if (!menu.restore(list, h.nodes, h.cells)) return false;
+  list.epoch = h.epoch;
+  list.version = h.version;
+  table = h.table;
+  return true;
+}
+
+bool menuCacheSave(const DeviceList &list, const Menu &menu, uint8_t table) {
+  if (!mounted) return false;
+
+  CacheHeader h = {CACHE_MAGIC, CACHE_FORMAT, table, sizeof(MenuNode), list.hash, list.epoch,
+                   list.version, list.length, menu.nodeCount(), menu.cellCount(), 0, 0};
+  h.checksum = fnv1a(list.text, h.textLength);
+  h.checksum = fnv1a(menu.nodeData(), h.nodes * sizeof(MenuNode), h.checksum);
+  h.checksum = fnv1a(menu.cellData(), h.cells, h.checksum);
+
+  File f = LittleFS.open(CACHE_TEMP, "w");
+  if (!f) return false;
+  bool ok = writeBlock(f, &h, sizeof(h)) && writeBlock(f, list.text, h.textLength) &&
+            writeBlock(f, menu.nodeData(), h.nodes * sizeof(MenuNode)) &&
+            writeBlock(f, menu.cellData(), h.cells);
+  f.close();
+  if (!ok || !LittleFS.rename(CACHE_TEMP, CACHE_FILE)) {
+    LittleFS.remove(CACHE_TEMP);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,270 @@
+#include "Network.h"
+#include <WiFi.h>
+#include <AsyncMqttClient.h>
+#include "SpscRing.h"
+#include "Menu.h"
+#include "Trace.h"
+#include "WireFormat.h"
+
+//set with build_flags, e.g. -DWIFI_SSID=\"home\" -DMQTT_HOST=\"0.tcp.ngrok.io\" -DMQTT_PORT=12345
+#ifndef WIFI_SSID
+#define WIFI_SSID ""
+#endif
+#ifndef WIFI_PASSWORD
+#define WIFI_PASSWORD ""
+#endif
+#ifndef MQTT_HOST
+#define MQTT_HOST ""
+#endif
+#ifndef MQTT_PORT
+#define MQTT_PORT 1883
+#endif
+
+#define REQUEST_TOPIC "deviceList"
+#define RESPONSE_TOPIC "deviceList/response/" //followed by the client id, only this display gets it
+#define TRACE_TOPIC "trace"
+#define METRICS_TOPIC "braillink/metrics"
+
+constexpr uint32_t SUPERVISE_MS = 500;
+constexpr uint32_t RETRY_MIN_MS = 1000; //broker reconnect backoff, doubles up to RETRY_MAX_MS
+constexpr uint32_t RETRY_MAX_MS = 30000;
+constexpr uint32_t METRICS_MS = 60000;
+
+static SpscRing<NetEvent, 16> events;    //network task -> ui
+static SpscRing<NetCommand, 8> commands; //ui -> network task
+static TaskHandle_t uiTask;
+static TaskHandle_t netTask;
+static AsyncMqttClient mqtt;
+static size_t (*formatMetrics)(char *buf, size_t size);
+static char clientId[24];
+static char responseTopic[sizeof(RESPONSE_TOPIC) + sizeof(clientId)];
+
+//written by the mqtt callbacks in the AsyncTCP task, read by the network task
+static std::atomic<uint32_t> brokerUp{0};
+static std::atomic<uint32_t> connecting{0};
+
+//Two lists so one can be filled while the ui shows the other. Whoever owns a list is the
+//only one touching it: the AsyncTCP task while it is FILLING, the ui once it has been POSTED.
+enum ListState : uint32_t { LIST_FREE, LIST_FILLING, LIST_READY, LIST_POSTED };
+static DeviceList lists[2];
+static std::atomic<uint32_t> listState[2];
+static uint32_t listEdge[2]; //micros() of the first segment, written before the list is READY
+static uint8_t listEvent[2];  //NET_DEVICE_LIST or NET_DEVICE_DELTA, same
+static int8_t filling = -1; //list being received, AsyncTCP task only
+static uint8_t header[WIRE_HEADER]; //the start of a reply until its header is whole, same
+static size_t headerHave = 0;
+static std::atomic<uint32_t> listsDropped{0}; //replies that came while both lists were taken, or were broken
+
+static bool post(uint8_t type, DeviceList *list = nullptr, uint32_t edge = micros()) {
+  if (!events.push({type, list, edge})) return false;
+  xTaskNotifyGive(uiTask);
+  return true;
+}
+
+static void onMqttConnect(bool) {
+  mqtt.subscribe(responseTopic, 0);
+  brokerUp.store(1);
+  connecting.store(0);
+  xTaskNotifyGive(netTask);
+}
+
+//gives back the list of a message that was cut off before its last segment
+static void abandonFilling() {
+  if (filling < 0) return;
+  listState[filling].store(LIST_FREE);
+  listsDropped++;
+  filling = -1;
+}
+
+static void onMqttDisconnect(AsyncMqttClientDisconnectReason) {
+  abandonFilling();
+  brokerUp.store(0);
+  connecting.store(0);
+  xTaskNotifyGive(netTask);
+}
+
+//Takes a list for a reply whose header (or all of it, if it is shorter) is in header: WIRE_VERSION
+//needs nothing, a snapshot or a delta gets a free list. False if there is nothing to fill.
+static bool startReply(const uint8_t *header, size_t len, size_t total) {
+  WireReader r(header, len);
+  WireHeader h;
+  if (!readWireHeader(r, h)) {
+    listsDropped++; //"ERROR: ..." or something we don't know
+    return false;
+  }
+  if (h.kind == WIRE_VERSION) {
+    trace(TRACE_LIST_UNCHANGED);
+    return false;
+  }
+  if ((h.kind != WIRE_SNAPSHOT && h.kind != WIRE_DELTA) || total > DEVICE_LIST_BYTES) {
+    listsDropped++;
+    return false;
+  }
+
+  for (uint8_t i = 0; i < 2 && filling < 0; i++) {
+    uint32_t free = LIST_FREE;
+    if (listState[i].compare_exchange_strong(free, LIST_FILLING)) filling = i;
+  }
+  if (filling < 0) {
+    listsDropped++;
+    return false;
+  }
+  listEdge[filling] = micros();
+  listEvent[filling] = h.kind == WIRE_DELTA ? NET_DEVICE_DELTA : NET_DEVICE_LIST;
+  return true;
+}
+
+//Called for every TCP segment of a message, index is where this one starts in the payload.
+//The header is collected first, it may be split over segments as well; once it is whole the
+//reply is either done with or copied into a free list segment by segment as it comes in. Once the
+//last one is there a snapshot is decoded, a delta is left for the ui to apply. Apart from the
+//header nothing is ever buffered twice.
+static void onMqttMessage(char *topic, char *payload, AsyncMqttClientMessageProperties,
+                          size_t len, size_t index, size_t total) {
+  if (strcmp(topic, responseTopic) != 0) return;
+
+  if (index == 0) {
+    abandonFilling();
+    headerHave = 0;
+  }
+  if (index < WIRE_HEADER) {
+    if (index != headerHave) return; //a segment went missing
+    size_t n = min(len, WIRE_HEADER - index);
+    memcpy(header + index, payload, n);
+    headerHave += n;
+    if (headerHave < WIRE_HEADER && headerHave < total) return;
+    if (!startReply(header, headerHave, total)) return;
+    memcpy(lists[filling].text, header, index); //the segments before this one
+  }
+  if (filling < 0) return;
+
+  DeviceList &list = lists[filling];
+  memcpy(list.text + index, payload, len);
+  if (index + len < total) return;
+
+  list.length = total;
+  if (listEvent[filling] == NET_DEVICE_DELTA || parseDeviceList(list)) {
+    listState[filling].store(LIST_READY);
+    xTaskNotifyGive(netTask);
+  } else {
+    listsDropped++;
+    listState[filling].store(LIST_FREE);
+  }
+  filling = -1;
+}
+
+//same payload the backend's routines use on "<room>/<device>": ON or OFF
+static void publishAction(const char *topic, uint8_t action) {
+  mqtt.publish(topic, 0, false, action == ACTION_ON ? "ON" : "OFF");
+}
+
+//Owns the connection: WiFi reconnects by itself, the broker is retried with backoff.
+//This task is the only producer of events and the only consumer of commands.
+static void netLoop(void *) {
+  bool online = false;
+  uint32_t retryMs = RETRY_MIN_MS;
+  uint32_t nextTry = millis();
+  uint32_t nextMetrics = millis() + METRICS_MS;
+
+  WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(true);
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SUPERVISE_MS));
+
+    bool wifi = WiFi.status() == WL_CONNECTED;
+    bool up = wifi && brokerUp.load();
+    if (up != online) {
+      online = up;
+      post(up ? NET_ONLINE : NET_OFFLINE);
+      if (up) retryMs = RETRY_MIN_MS;
+    }
+
+    if (wifi && !up && connecting.load() == 0 && (int32_t)(millis() - nextTry) >= 0) {
+      connecting.store(1);
+      mqtt.connect();
+      nextTry = millis() + retryMs;
+      retryMs = min(retryMs * 2, RETRY_MAX_MS);
+    }
+
+    for (uint8_t i = 0; i < 2; i++) {
+      if (listState[i].load() != LIST_READY) continue;
+      //handed over before the ui can see it; a full ring puts it back for the next round
+      listState[i].store(LIST_POSTED);
+      if (!post(listEvent[i], &lists[i], listEdge[i])) listState[i].store(LIST_READY);
+    }
+
+    NetCommand command;
+    while (commands.pop(command)) {
+      switch (command.type) {
+        case NET_REQUEST_DEVICE_LIST: {
+          if (!online) break; //the ui asks again on NET_ONLINE
+          char request[64];
+          snprintf(request, sizeof(request), "since %lu %lu %s", (unsigned long)command.epoch,
+                   (unsigned long)command.version, clientId);
+          mqtt.publish(REQUEST_TOPIC, 0, false, request);
+          break;
+        }
+        case NET_DEVICE_ACTION:
+          if (online) publishAction(command.topic, command.action);
+          break;
+      }
+    }
+
+    const uint8_t *batch;
+    size_t len;
+    if (online && traceBatch(batch, len)) {
+      mqtt.publish(TRACE_TOPIC, 0, false, (const char *)batch, len);
+      traceBatchSent();
+    }
+
+    if (online && formatMetrics != nullptr && (int32_t)(millis() - nextMetrics) >= 0) {
+      static char metrics[1024];
+      nextMetrics = millis() + METRICS_MS;
+      len = formatMetrics(metrics, sizeof(metrics));
+      if (len > 0) mqtt.publish(METRICS_TOPIC, 0, false, metrics, len);
+    }
+  }
+}
+
+bool networkBegin(TaskHandle_t ui) {
+  if (!networkEnabled()) return false;
+  uiTask = ui;
+  snprintf(clientId, sizeof(clientId), "braille-%012llx", (unsigned long long)ESP.getEfuseMac());
+  snprintf(responseTopic, sizeof(responseTopic), RESPONSE_TOPIC "%s", clientId);
+  mqtt.setClientId(clientId);
+  mqtt.onConnect(onMqttConnect);
+  mqtt.onDisconnect(onMqttDisconnect);
+  mqtt.onMessage(onMqttMessage);
+  mqtt.setServer(MQTT_HOST, MQTT_PORT);
+  xTaskCreatePinnedToCore(netLoop, "net", 4096, nullptr, 1, &netTask, PRO_CPU_NUM);
+  return true;
+}
+
+void networkSetMetrics(size_t (*format)(char *buf, size_t size)) {
+  formatMetrics = format;
+}
+
+bool networkEnabled() {
+  return WIFI_SSID[0] != '\0' && MQTT_HOST[0] != '\0';
+}
+
+bool nextNetEvent(NetEvent &event) {
+  return events.pop(event);
+}
+
+bool sendNetCommand(const NetCommand &command) {
+  if (netTask == nullptr || !commands.push(command)) return false;
+  xTaskNotifyGive(netTask);
+  return true;
+}
+
+//the ui owns a POSTED list, nobody else writes its state until it is FREE
+void releaseDeviceList(const DeviceList *list) {
+  listState[list - lists].store(LIST_FREE);
+}
+
+uint32_t deviceListsDropped() {
+  return listsDropped.load();
+}
@@ -0,0 +1,47 @@
+#include "PanelConfig.h"
+#include <LittleFS.h>
+
+#define PANEL_FILE "/panel"
+
+static LineGeometry described; //the panel /panel describes, if it isn't a built-in one
+
+//nullptr if config is neither a built-in panel nor a description of one that fits
+static const LineGeometry *parsePanel(const char *config) {
+  const LineGeometry *known = findPanel(config);
+  if (known != nullptr) return known;
+
+  unsigned cells, lines, cellPitch, dotPitch, firstRow, reversed;
+  if (sscanf(config, "%u %u %u %u %u %u", &cells, &lines, &cellPitch, &dotPitch, &firstRow, &reversed) != 6) {
+    return nullptr;
+  }
+  if (cells > MAX_LINE_CELLS || lines > MAX_LINE_CELLS || cellPitch > 255 || dotPitch >= ROW_SIZE ||
+      firstRow >= ROW_SIZE || reversed > 1) {
+    return nullptr;
+  }
+  PanelGeometry panel = {(uint8_t)cells, (uint8_t)lines, (uint8_t)cellPitch, (uint8_t)dotPitch,
+                         (uint8_t)firstRow, reversed == 1};
+  if (!panelFits(panel)) return nullptr;
+  described = makeGeometry("described", panel);
+  return &described;
+}
+
+const LineGeometry &panelLoad() {
+  File f = LittleFS.open(PANEL_FILE, "r");
+  if (!f) return PANELS[0];
+  char config[32];
+  size_t n = f.readBytesUntil('\n', config, sizeof(config) - 1);
+  f.close();
+  config[n] = '\0';
+
+  const LineGeometry *panel = parsePanel(config);
+  return panel != nullptr ? *panel : PANELS[0];
+}
+
+bool panelSave(const char *config) {
+  if (parsePanel(config) == nullptr) return false;
+  File f = LittleFS.open(PANEL_FILE, "w");
+  if (!f) return false;
+  bool ok = f.print(config) == strlen(config) && f.print('\n') == 1;
+  f.close();
+  return ok;
+}
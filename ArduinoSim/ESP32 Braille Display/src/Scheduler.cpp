@@ -0,0 +1,143 @@
+#include "Scheduler.h"
+#include <esp_sleep.h>
+
+int8_t Scheduler::every(const char *name, uint32_t periodMs, TaskFunction fn) {
+  return add(name, periodMs * 1000, 0, fn);
+}
+
+int8_t Scheduler::after(const char *name, uint32_t delayMs, TaskFunction fn) {
+  return add(name, 0, delayMs * 1000, fn);
+}
+
+int8_t Scheduler::add(const char *name, uint32_t periodUs, uint32_t delayUs, TaskFunction fn) {
+  for (uint8_t id = 0; id < MAX_SCHEDULED_TASKS; id++) {
+    //the running task's slot stays taken until it has returned
+    if (_task[id].fn != nullptr || id == _running) continue;
+    _task[id] = {name, fn, periodUs, (uint32_t)micros() + delayUs, 0, 0, 0, 0};
+    push(id);
+    return id;
+  }
+  return -1;
+}
+
+void Scheduler::cancel(int8_t id) {
+  if (id < 0 || id >= MAX_SCHEDULED_TASKS || _task[id].fn == nullptr) return;
+  _task[id].fn = nullptr;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_heap[i] == id) {
+      removeAt(i);
+      break;
+    }
+  }
+}
+
+void Scheduler::run() {
+  if (_count == 0) {
+    delay(10);
+    return;
+  }
+
+  for (;;) {
+    uint8_t id = _heap[0];
+    Task &t = _task[id];
+    int32_t late = micros() - t.due;
+    if (late < 0) {
+      idle(-late);
+      return;
+    }
+
+    removeAt(0);
+    _running = id;
+    uint32_t start = micros();
+    t.fn();
+    uint32_t took = micros() - start;
+    _running = -1;
+
+    t.runs++;
+    t.totalUs += took;
+    if (took > t.maxUs) t.maxUs = took;
+
+    //one-shots are done, and a task may have cancelled itself
+    if (t.periodUs == 0 || t.fn == nullptr) {
+      t.fn = nullptr;
+      if (_count == 0) return;
+      continue;
+    }
+
+    if (took > t.periodUs || (uint32_t)late >= t.periodUs) t.overruns++;
+    t.due += t.periodUs;
+    //missed slots are skipped, not run back to back
+    if ((int32_t)(micros() - t.due) >= 0) t.due = micros() + t.periodUs;
+    push(id);
+  }
+}
+
+void Scheduler::idle(uint32_t waitUs) {
+  if (_prepareSleep != nullptr && waitUs >= MIN_LIGHT_SLEEP_US && _prepareSleep()) {
+    uint32_t start = micros();
+    esp_sleep_enable_timer_wakeup(waitUs);
+    esp_light_sleep_start();
+    _sleptUs += micros() - start;
+    _sleeps++;
+    if (_wake != nullptr) _wake();
+  } else if (waitUs >= 1000) {
+    delay(waitUs / 1000); //lets the idle task and lower priority tasks run
+  } else {
+    delayMicroseconds(waitUs);
+  }
+}
+
+void Scheduler::setLightSleep(bool (*prepare)(), void (*wake)()) {
+  _prepareSleep = prepare;
+  _wake = wake;
+}
+
+void Scheduler::siftUp(uint8_t i) {
+  while (i > 0) {
+    uint8_t parent = (i - 1) / 2;
+    if (!earlier(_heap[i], _heap[parent])) break;
+    uint8_t tmp = _heap[i];
+    _heap[i] = _heap[parent];
+    _heap[parent] = tmp;
+    i = parent;
+  }
+}
+
+void Scheduler::siftDown(uint8_t i) {
+  for (;;) {
+    uint8_t first = i;
+    uint8_t left = 2 * i + 1;
+    uint8_t right = left + 1;
+    if (left < _count && earlier(_heap[left], _heap[first])) first = left;
+    if (right < _count && earlier(_heap[right], _heap[first])) first = right;
+    if (first == i) return;
+    uint8_t tmp = _heap[i];
+    _heap[i] = _heap[first];
+    _heap[first] = tmp;
+    i = first;
+  }
+}
+
+void Scheduler::push(uint8_t id) {
+  _heap[_count] = id;
+  siftUp(_count++);
+}
+
+void Scheduler::removeAt(uint8_t i) {
+  _heap[i] = _heap[--_count];
+  if (i < _count) {
+    siftDown(i);
+    siftUp(i);
+  }
+}
+
+void Scheduler::print(Print &out) const {
+  out.printf("%-10s %8s %8s %8s %8s\n", "task", "runs", "avg us", "max us", "overrun");
+  for (uint8_t id = 0; id < MAX_SCHEDULED_TASKS; id++) {
+    const Task &t = _task[id];
+    if (t.fn == nullptr) continue;
+    out.printf("%-10s %8u %8u %8u %8u\n", t.name, (unsigned)t.runs,
+               (unsigned)(t.runs ? t.totalUs / t.runs : 0), (unsigned)t.maxUs, (unsigned)t.overruns);
+  }
+  out.printf("light sleep: %u times, %u ms\n", (unsigned)_sleeps, (unsigned)(_sleptUs / 1000));
+}
@@ -0,0 +1,90 @@
+#include "Trace.h"
+
+constexpr uint32_t DRAIN_MS = 50;
+constexpr int LINE_MAX = 48; //longest text line a record turns into
+
+SpscRing<TraceRecord, TRACE_RECORDS> traceRing[portNUM_PROCESSORS];
+
+static const char *const EVENT_NAMES[TRACE_EVENT_COUNT] = {
+  "button", "line", "online", "offline", "device list", "menu full", "action", "action offline",
+  "grade", "dropped", "list unchanged", "cache saved",
+  "device delta"
+};
+
+static std::atomic<uint8_t> sink{TRACE_TO_UART};
+static TraceRecord batch[TRACE_BATCH];
+static std::atomic<uint32_t> batchBytes{0}; //0 while the drain may fill the batch
+static uint32_t dropsReported = 0; //drain task only
+
+//a TRACE_DROPPED record first if the rings lost anything, then the rings one after another
+static bool nextRecord(TraceRecord &record) {
+  uint32_t dropped = traceDropped();
+  if (dropped != dropsReported) {
+    uint32_t lost = dropped - dropsReported;
+    record = {(uint32_t)micros(), TRACE_DROPPED, 0, (uint16_t)(lost > 0xFFFF ? 0xFFFF : lost)};
+    dropsReported = dropped;
+    return true;
+  }
+  for (auto &ring : traceRing) {
+    if (ring.pop(record)) return true;
+  }
+  return false;
+}
+
+static void printRecord(const TraceRecord &record) {
+  const char *name = record.event < TRACE_EVENT_COUNT ? EVENT_NAMES[record.event] : "?";
+  Serial.printf("%10lu us %s %u %u\n", (unsigned long)record.micros, name, record.a, record.b);
+}
+
+//Takes only what the sink can accept right now; whatever it can't stays in the rings, and once
+//they are full new records are dropped there rather than anybody waiting.
+static void drainLoop(void *) {
+  TraceRecord record;
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(DRAIN_MS));
+    switch (sink.load()) {
+      case TRACE_TO_NOTHING:
+        while (nextRecord(record)) {}
+        break;
+      case TRACE_TO_UART:
+        while (Serial.availableForWrite() >= LINE_MAX && nextRecord(record)) printRecord(record);
+        break;
+      case TRACE_TO_MQTT: {
+        if (batchBytes.load(std::memory_order_acquire) != 0) break; //previous batch not out yet
+        size_t n = 0;
+        while (n < TRACE_BATCH && nextRecord(batch[n])) n++;
+        if (n > 0) batchBytes.store(n * sizeof(TraceRecord), std::memory_order_release);
+        break;
+      }
+    }
+  }
+}
+
+void traceBegin(TraceSink to) {
+  sink.store(to);
+  xTaskCreatePinnedToCore(drainLoop, "trace", 3072, nullptr, tskIDLE_PRIORITY + 1, nullptr, tskNO_AFFINITY);
+}
+
+void traceSetSink(TraceSink to) {
+  sink.store(to);
+}
+
+TraceSink traceSink() {
+  return (TraceSink)sink.load();
+}
+
+uint32_t traceDropped() {
+  uint32_t dropped = 0;
+  for (auto &ring : traceRing) dropped += ring.dropped();
+  return dropped;
+}
+
+bool traceBatch(const uint8_t *&data, size_t &len) {
+  len = batchBytes.load(std::memory_order_acquire);
+  data = (const uint8_t *)batch;
+  return len != 0;
+}
+
+void traceBatchSent() {
+  batchBytes.store(0, std::memory_order_release);
+}
@@ -1,17 +1,32 @@
 #include <MD_Parola.h>
 #include <SPI.h>
 #include <WiFi.h>
-#include <map>
-#include <string>
-
-//matrix display
+#include "BrailleLayout.h"
+#include "BrailleLine.h"
+#include "LineRenderer.h"
+#include "Menu.h"
+#include "MenuCache.h"
+#include "PanelConfig.h"
+#include "Buttons.h"
+#include "LatencyPipeline.h"
+#include "Scheduler.h"
+#include "Network.h"
+#include "WireFormat.h"
+#include "CpuLoad.h"
+#include "Trace.h"
+#include <driver/uart.h>
+#include <esp_sleep.h>
+
+//matrix display, as many modules as the panel in /panel has (PanelConfig.h)
 #define HARDWARE_TYPE MD_MAX72XX::FC16_HW
-#define MAX_DEVICES 8
+//CLK and DATA are the VSPI host's SCK and MOSI, so MD_MAX72XX sends over it with DMA instead of bit banging
 #define CLK_PIN 18
 #define DATA_PIN 23
 #define CS_PIN 21
+#define SPI_CLOCK_HZ 10000000 //the MAX7219's limit
 
-MD_MAX72XX matrix = MD_MAX72XX(HARDWARE_TYPE, DATA_PIN, CLK_PIN, CS_PIN, MAX_DEVICES);
+const LineGeometry *panel;
+MD_MAX72XX *matrix;
 
 //buttons
 #define ENTER_PIN 12
@@ -29,258 +44,473 @@ bool GREEN_LED = false;
 bool YELLOW_LED = false;
 bool RED_LED = false;*/
 
-// Variables will change:
-int lastState = HIGH; // the previous state from the input pin
-int currentState;     // the current reading from the input pin
-
-//maps each letter to a binary value
-std::map<char,String> letters = {
-  {'a', "100000"},
-  {'b', "110000"},
-  {'c', "100100"},
-  {'d', "100110"},
-  {'e', "100010"},
-  {'f', "110100"},
-  {'g', "110110"},
-  {'h', "110010"},
-  {'i', "010100"},
-  {'j', "010110"},
-  {'k', "101000"},
-  {'l', "111000"},
-  {'m', "101100"},
-  {'n', "101110"},
-  {'o', "101010"},
-  {'p', "111100"},
-  {'q', "111110"},
-  {'r', "111010"},
-  {'s', "011100"},
-  {'t', "011110"},
-  {'u', "101001"},
-  {'v', "111001"},
-  {'w', "010111"},
-  {'x', "101101"},
-  {'y', "111101"},
-  {'z', "101011"}
-};
-
-//Set all leds off
-String binLetter [13] = {"000000","000000","000000","000000","000000","000000","000000","000000","000000","000000","000000","000000"};
-int r = 0;
+const uint8_t buttonPins[BUTTON_COUNT] = {ENTER_PIN, BACK_PIN, NEXT_PIN, PREV_PIN};
+
+//button and network events are handled and rendered here, on APP_CPU with loop();
+//the network has its own task on PRO_CPU. loop() runs the scheduler.
+TaskHandle_t uiTask;
+LatencyPipeline latency; //button or mqtt edge to dots, stage by stage
+
+Scheduler scheduler;
+bool telemetry = false; //print the stats every TELEMETRY_MS
+#define CONSOLE_MS 50
+#define TELEMETRY_MS 10000
+
+//the name of the current menu item, the display shows a window of it as wide as the panel
+BrailleLine line(MAX_LINE_CELLS);
+uint8_t table = TABLE_UEB_GRADE2; //TranslationTable: grade 1 spells every word out, computer braille uses 8 dots
+volatile bool tableRequested = false; //set by the console, done by the ui task
+volatile bool spiBenchRequested = false; //same
+LineRenderer *renderer; //only rewrites the cells that changed
+//drawn over the name by the renderer's overlay, a blink step only sends the rows of its dots
+#define CURSOR_BLINK_MS 500    //dots 7-8 under the first cell while on an action, ENTER runs it;
+                               //on a device that reports on, dot 8 stays there
+#define ATTENTION_BLINK_MS 200 //the last cell, an action couldn't be sent
+bool attention = false; //until the next press
+
+//rooms -> devices -> on/off, rebuilt whenever the backend sends its device list
+Menu menu;
+DeviceList *shownList = nullptr; //kept until the next list replaces it, actions need its names; deltas patch it
+//shown until the backend has sent its list, same format as deviceList/response
+const char DEMO_DEVICES[] = "bathroom-lights,kitchen-lights;thermostats,bedroom-lights;doorlocks";
+DeviceList bootList; //the cached list from the last time, or the demo if there is none
+bool showingDemo = false; //never cached
+
+void selectNode();
+void showStatus();
+void showLine();
+uint16_t phaseNow(uint16_t periodMs);
+void runAction(const MenuNode &node);
+void uiLoop(void *);
+void handleNetEvent(const NetEvent &event);
+void requestDevices();
+void showDevices(DeviceList &list);
+void applyDelta(const DeviceList &delta);
+void rebuildMenu();
+void nextTable();
+void saveMenu();
+bool handleButton(const ButtonEvent &event);
+void console();
+void printTelemetry();
+void printRenderStats();
+void spiBench();
+size_t formatMetrics(char *buf, size_t size);
+bool prepareSleep();
+
 void setup() {
-  matrix.begin();
-  matrix.control(MD_MAX72XX::INTENSITY, 5);
-  matrix.clear();
-  Serial.begin(9600);
-  pinMode(NEXT_PIN, INPUT_PULLDOWN);
-  pinMode(PREV_PIN, INPUT_PULLDOWN);
-  pinMode(ENTER_PIN, INPUT_PULLDOWN);
-  pinMode(BACK_PIN, INPUT_PULLDOWN);
+  //the panel decides how long the chain is, so LittleFS comes first
+  bool cache = menuCacheBegin();
+  panel = &panelLoad();
+  matrix = new MD_MAX72XX(HARDWARE_TYPE, DATA_PIN, CLK_PIN, CS_PIN, panel->devices);
+  matrix->setSpiClock(SPI_CLOCK_HZ);
+  renderer = new LineRenderer(*matrix, *panel);
+  line.setWidth(panel->cells);
+  matrix->begin();
+  matrix->control(MD_MAX72XX::INTENSITY, 5);
+  matrix->clear();
+  Serial.begin(115200); //same as monitor_speed
+  traceBegin(TRACE_TO_UART);
 
   /*pinMode(BLUE_LED, OUTPUT);
   pinMode(GREEN_LED, OUTPUT);
   pinMode(YELLOW_LED, OUTPUT);
   pinMode(RED_LED, OUTPUT);*/
-}
 
-void clearBin();
-void convertWord(String word, String binLetter[]);
-void displayBrailleFormat(String cell1, String cell2, String cell3, String cell4, String cell5, String cell6, 
-                          String cell7, String cell8, String cell9, String cell10, String cell11, String cell12, String cell13);
+  //the menu from flash is on the display before anything else starts, the backend's
+  //list replaces it later only if it changed
+  if(cache && menuCacheLoad(bootList, menu, table)){
+    shownList = &bootList;
+    selectNode();
+    showLine();
+    Serial.printf("cached menu, %u devices in %u rooms, %lu ms after reset\n", bootList.count,
+                  bootList.rooms, millis());
+  }else{
+    strcpy(bootList.text, DEMO_DEVICES);
+    bootList.length = strlen(DEMO_DEVICES);
+    parseDeviceList(bootList);
+    bootList.epoch = bootList.version = 0;
+    showingDemo = true;
+    showDevices(bootList);
+  }
+
+  //above loop() so a press is handled as soon as the debouncer reports it
+  xTaskCreatePinnedToCore(uiLoop, "ui", 4096, nullptr, 2, &uiTask, APP_CPU_NUM);
+  buttonsBegin(buttonPins, uiTask);
+  networkSetMetrics(formatMetrics);
+  if(!networkBegin(uiTask)){
+    Serial.println("no WIFI_SSID/MQTT_HOST configured, running offline");
+  }
+  cpuLoadBegin();
+
+  scheduler.every("console", CONSOLE_MS, console);
+  scheduler.every("telemetry", TELEMETRY_MS, printTelemetry);
+  //sleep between deadlines, a button press or serial input wakes the board early
+  uart_set_wakeup_threshold(UART_NUM_0, 3);
+  esp_sleep_enable_uart_wakeup(UART_NUM_0);
+  scheduler.setLightSleep(prepareSleep, buttonsWake);
+}
 
 void loop() {
-  // read the state of the switch/button:
-  //String word[15] = {"bathroom","kitchen","bedroom","lights", "doorlocks", "thermostats", "locked", "unlocked"} ;
-
-  /*convertWord(word[r], binLetter);
-
-  if(digitalRead(NEXT_PIN) == HIGH){
-    Serial.println("The state changed HIGH");
-    //digitalWrite(BLUE_LED, true);
-    r++;}
-
-  if(digitalRead(PREV_PIN) == HIGH){
-    Serial.println("The state changed HIGH");
-    //digitalWrite(YELLOW_LED, true);
-    r--;}
-
-  if(digitalRead(ENTER_PIN) == LOW){
-    Serial.println("The state changed LOW ");
-    //digitalWrite(GREEN_LED, true);}
-
-  delay(10000);*/
-  
-  String word[15] = {"bathroom","kitchen","bedroom","lights", "doorlocks", "thermostats", "locked", "unlocked"} ;
-  //convertWord(word, binLetter);
-  //delay(100000);
-  int i = 0;
-
-  while(i < sizeof(word)){
-    clearBin();
-    convertWord(word[i], binLetter);
-    i++;
-    delay(3000);
+  scheduler.run();
+}
+
+//'l' prints the input to dots latency histograms, 'r' clears them, 's' prints the scheduler stats,
+//'c' prints the load of each core since the last time, 'd' prints the cells rewritten per second, 'g' switches grade 1 / grade 2 / 8-dot computer braille, 't' turns the periodic telemetry on and off,
+//'o' sends the trace to the uart, mqtt or nowhere in turn, 'p' switches to the next built-in panel size and restarts, 'b' times full frames over SPI. The character that wakes the board from light
+//sleep is lost, send it again.
+void console(){
+  int c;
+  while((c = Serial.read()) >= 0){
+    if(c == 'l'){
+      latency.print(Serial);
+      Serial.printf("edges dropped: %u\n", (unsigned)buttonEdgesDropped());
+    }
+    if(c == 'r'){
+      latency.reset();
+    }
+    if(c == 's'){
+      scheduler.print(Serial);
+    }
+    if(c == 'c'){
+      cpuLoadPrint(Serial);
+    }
+    if(c == 'd'){
+      printRenderStats();
+    }
+    if(c == 'g'){
+      tableRequested = true; //the menu belongs to the ui task
+      xTaskNotifyGive(uiTask);
+    }
+    if(c == 't'){
+      telemetry = !telemetry;
+    }
+    if(c == 'b'){
+      spiBenchRequested = true; //the matrix belongs to the ui task
+      xTaskNotifyGive(uiTask);
+    }
+    if(c == 'o'){
+      static const char *const sinks[] = {"nowhere", "uart", "mqtt"};
+      TraceSink sink = (TraceSink)((traceSink() + 1) % 3);
+      traceSetSink(sink);
+      Serial.printf("trace to %s\n", sinks[sink]);
+    }
+    if(c == 'p'){
+      uint8_t next = 0;
+      for(uint8_t i = 0; i < PANEL_COUNT; i++){
+        if(&PANELS[i] == panel) next = (i + 1) % PANEL_COUNT;
+      }
+      if(panelSave(PANELS[next].name)){
+        Serial.printf("panel %s, %u cells on %u modules, restarting\n", PANELS[next].name,
+                      PANELS[next].cells, PANELS[next].devices);
+        Serial.flush();
+        ESP.restart();
+      }
+      Serial.println("panel not saved");
+    }
+  }
+}
+
+void printTelemetry(){
+  if(!telemetry) return;
+  Serial.printf("uptime %lus, free heap %u, device lists dropped %u, trace records dropped %u\n",
+                millis() / 1000, (unsigned)ESP.getFreeHeap(), (unsigned)deviceListsDropped(),
+                (unsigned)traceDropped());
+  cpuLoadPrint(Serial);
+  latency.print(Serial);
+  printRenderStats();
+  scheduler.print(Serial);
+}
+
+//rates since the last time this was printed
+void printRenderStats(){
+  static uint32_t lastMillis = 0;
+  static uint32_t lastCells = 0;
+  static uint32_t lastCommits = 0;
+  uint32_t now = millis();
+  uint32_t cells = renderer->cellsRewritten();
+  uint32_t commits = renderer->commits();
+  float seconds = (now - lastMillis) / 1000.0f;
+  if(seconds > 0){
+    Serial.printf("cells rewritten %.1f/s in %.1f commits/s (%u cells, %u commits since boot)\n",
+                  (cells - lastCells) / seconds, (commits - lastCommits) / seconds,
+                  (unsigned)cells, (unsigned)commits);
   }
+  const CellCache &strips = menu.strips();
+  Serial.printf("name strips: %u hits, %u misses, %u of %u kept\n", (unsigned)strips.hits(),
+                (unsigned)strips.misses(), strips.size(), CELL_CACHE_ENTRIES);
+  lastMillis = now;
+  lastCells = cells;
+  lastCommits = commits;
 }
 
-void clearBin(){
-  for (int i=0; i < 13; i++){// 13 is too hardcoded 
-    binLetter[i] = "000000";
+//Sends every row of every module SPI_BENCH_FRAMES times, each row written back as it is so the
+//panel doesn't change, and compares the time with what the bits take on the wire at the clock set.
+#define SPI_BENCH_FRAMES 100
+void spiBench(){
+  uint32_t us = 0;
+  for(int f = 0; f < SPI_BENCH_FRAMES; f++){
+    matrix->beginFrame();
+    for(uint8_t dev = 0; dev < panel->devices; dev++){
+      for(uint8_t row = 0; row < ROW_SIZE; row++) matrix->setRow(dev, row, matrix->getRow(dev, row));
+    }
+    uint32_t t0 = micros();
+    matrix->commitFrame(); //flushBufferAll(), one transaction per row
+    us += micros() - t0;
   }
+  float frameUs = (float)us / SPI_BENCH_FRAMES;
+  float wireUs = ROW_SIZE * panel->devices * 16 * 1e6f / matrix->getSpiClock();
+  Serial.printf("%u modules: %.1f us/frame, %.1f us/row; on the wire at %lu Hz %.1f us/frame, %.1f us/row\n",
+                panel->devices, frameUs, frameUs / ROW_SIZE, (unsigned long)matrix->getSpiClock(), wireUs,
+                wireUs / ROW_SIZE);
 }
 
-void convertWord(String word, String binLetter[]){//this method converts words into a binary value used to turn certain leds on or off
-  
-  Serial.println(word);
-  for(int i = 0; i < word.length(); i++){
-    binLetter[i] = letters[word[i]].c_str(); //convert this specific letter to the set binary in the map
+size_t formatMetrics(char *buf, size_t size){
+  return latency.formatJson(buf, size);
+}
+
+bool prepareSleep(){
+  if(networkEnabled()) return false; //WiFi doesn't survive light sleep, it uses modem sleep instead
+  Serial.flush(); //the uart stops while asleep
+  return buttonsPrepareSleep();
+}
+
+void uiLoop(void *){
+  ButtonEvent event;
+  NetEvent netEvent;
+  for(;;){
+    //wakes for the next blink step too, if anything blinks
+    uint32_t blink = renderer->untilNextPhase(millis());
+    ulTaskNotifyTake(pdTRUE, blink ? pdMS_TO_TICKS(blink) : portMAX_DELAY);
+    while(nextButtonEvent(event)){
+      trace(TRACE_BUTTON, event.button, event.type);
+      latency.start(LATENCY_BUTTON, event.edgeMicros);
+      if(attention && event.type == BUTTON_PRESS){
+        attention = false;
+        renderer->setOverlay(panel->cells - 1, 0);
+      }
+      if(handleButton(event)){
+        latency.stamp(STAGE_TRANSLATE);
+        showLine();
+      }
+      latency.cancel(); //no-op once showLine() has filed it
+    }
+    while(nextNetEvent(netEvent)){
+      handleNetEvent(netEvent);
+    }
+    if(tableRequested){
+      tableRequested = false;
+      nextTable();
+    }
+    if(spiBenchRequested){
+      spiBenchRequested = false;
+      spiBench();
+    }
+    renderer->refresh(millis()); //blink steps, and overlay changes no commit has drawn yet
+  }
+}
+
+void handleNetEvent(const NetEvent &event){
+  switch(event.type){
+    case NET_ONLINE:
+      trace(TRACE_ONLINE);
+      requestDevices();
+      break;
+    case NET_OFFLINE:
+      trace(TRACE_OFFLINE);
+      break;
+    case NET_DEVICE_LIST:
+      if(!showingDemo && event.list->hash == shownList->hash){
+        //same devices, only the version and maybe their status moved on (e.g. a snapshot after a
+        //backend restart); the cache only has to follow a new epoch
+        trace(TRACE_LIST_UNCHANGED, 0, event.list->count);
+        bool newEpoch = shownList->epoch != event.list->epoch;
+        copyDeviceStatus(*shownList, *event.list);
+        shownList->epoch = event.list->epoch;
+        shownList->version = event.list->version;
+        releaseDeviceList(event.list);
+        showStatus();
+        if(newEpoch) saveMenu();
+        break;
+      }
+      latency.start(LATENCY_MQTT, event.edgeMicros);
+      showingDemo = false;
+      showDevices(*event.list);
+      saveMenu();
+      break;
+    case NET_DEVICE_DELTA:
+      latency.start(LATENCY_MQTT, event.edgeMicros);
+      applyDelta(*event.list);
+      releaseDeviceList(event.list);
+      break;
   }
+}
+
+//asks for what changed since the version shown, the demo has none so it gets a snapshot
+void requestDevices(){
+  NetCommand command = {NET_REQUEST_DEVICE_LIST};
+  if(!showingDemo){
+    command.epoch = shownList->epoch;
+    command.version = shownList->version;
+  }
+  sendNetCommand(command);
+}
 
-  String cell1 = binLetter[0];
-  Serial.println(cell1);// for testing
-  String cell2 = binLetter[1];
-  Serial.println(cell2);
-  String cell3 = binLetter[2];
-  Serial.println(cell3);
-  String cell4 = binLetter[3];
-  Serial.println(cell4);
-  String cell5 = binLetter[4];
-  Serial.println(cell5);
-  String cell6 = binLetter[5];
-  Serial.println(cell6);
-  String cell7 = binLetter[6];
-  Serial.println(cell7);
-  String cell8 = binLetter[7];
-  Serial.println(cell8);
-  String cell9 = binLetter[8];
-  Serial.println(cell9);
-  String cell10 = binLetter[9];
-  Serial.println(cell10);
-  String cell11 = binLetter[10];
-  Serial.println(cell11);
-  String cell12 = binLetter[11];
-  Serial.println(cell12);
-  String cell13 = binLetter[12];
-  Serial.println(cell13);
-  displayBrailleFormat(cell1, cell2, cell3, cell4, cell5, cell6, cell7, cell8, cell9, cell10, cell11, cell12, cell13);   
+//patches the shown list in place and rebuilds the menu from it; a delta that doesn't fit the
+//shown version (or breaks halfway) is answered with a request for a snapshot
+void applyDelta(const DeviceList &delta){
+  if(showingDemo){
+    requestDevices();
+    return;
+  }
+  uint32_t hash = shownList->hash;
+  bool ok = applyDeviceDelta(*shownList, delta.text, delta.length);
+  trace(TRACE_DEVICE_DELTA, ok, shownList->count);
+  //a delta never changes the epoch, only new names are worth a flash write; a status change
+  //or a version the cache is behind on costs a delta on the next boot at most
+  if(shownList->hash != hash){
+    rebuildMenu();
+    if(ok) saveMenu();
+  }else{
+    showStatus();
+  }
+  if(!ok){
+    shownList->epoch = shownList->version = 0;
+    requestDevices();
+  }
 }
-void displayBrailleFormat(String cell1, String cell2, String cell3, String cell4, String cell5, String cell6, String cell7, String cell8, String cell9, String cell10, String cell11, String cell12, String cell13) {
-//this sucked to hell, DON'T TOUCH!!!! 
-  //CELL1
-    matrix.setPoint(1, 57, cell1[0]- '0');
-    matrix.setPoint(3, 57, cell1[1]- '0');
-    matrix.setPoint(5, 57, cell1[2]- '0');
-
-    matrix.setPoint(1, 59, cell1[3]- '0');
-    matrix.setPoint(3, 59, cell1[4]- '0');
-    matrix.setPoint(5, 59, cell1[5]- '0');
-
-    //CELL2
-    matrix.setPoint(1, 62, cell2[0]- '0');
-    matrix.setPoint(3, 62, cell2[1]- '0');
-    matrix.setPoint(5, 62, cell2[2]- '0');
-
-    matrix.setPoint(1, 48, cell2[3]- '0');
-    matrix.setPoint(3, 48, cell2[4]- '0');
-    matrix.setPoint(5, 48, cell2[5]- '0');
-
-    //CELL3
-    matrix.setPoint(1, 51, cell3[0]- '0');
-    matrix.setPoint(3, 51, cell3[1]- '0');
-    matrix.setPoint(5, 51, cell3[2]- '0');
-
-    matrix.setPoint(1, 53, cell3[3]- '0');
-    matrix.setPoint(3, 53, cell3[4]- '0');
-    matrix.setPoint(5, 53, cell3[5]- '0');
-
-    //CELL4
-    matrix.setPoint(1, 40, cell4[0]- '0');
-    matrix.setPoint(3, 40, cell4[1]- '0');
-    matrix.setPoint(5, 40, cell4[2]- '0');
-
-    matrix.setPoint(1, 42, cell4[3]- '0');
-    matrix.setPoint(3, 42, cell4[4]- '0');
-    matrix.setPoint(5, 42, cell4[5]- '0');
-
-    //CELL5
-    matrix.setPoint(1, 45, cell5[0]- '0');
-    matrix.setPoint(3, 45, cell5[1]- '0');
-    matrix.setPoint(5, 45, cell5[2]- '0');
-
-    matrix.setPoint(1, 47, cell5[3]- '0');
-    matrix.setPoint(3, 47, cell5[4]- '0');
-    matrix.setPoint(5, 47, cell5[5]- '0');
-
-
-    //CELL6
-    matrix.setPoint(1, 34, cell6[0]- '0');
-    matrix.setPoint(3, 34, cell6[1]- '0');
-    matrix.setPoint(5, 34, cell6[2]- '0');
-
-    matrix.setPoint(1, 36, cell6[3]- '0');
-    matrix.setPoint(3, 36, cell6[4]- '0');
-    matrix.setPoint(5, 36, cell6[5]- '0');
-
-
-    //CELL7
-    matrix.setPoint(1, 39, cell7[0]- '0');
-    matrix.setPoint(3, 39, cell7[1]- '0');
-    matrix.setPoint(5, 39, cell7[2]- '0');
-
-    matrix.setPoint(1, 25, cell7[3]- '0');
-    matrix.setPoint(3, 25, cell7[4]- '0');
-    matrix.setPoint(5, 25, cell7[5]- '0');
-
-    //CELL8
-    matrix.setPoint(1, 28, cell8[0]- '0');
-    matrix.setPoint(3, 28, cell8[1]- '0');
-    matrix.setPoint(5, 28, cell8[2]- '0');
-
-    matrix.setPoint(1, 30, cell8[3]- '0');
-    matrix.setPoint(3, 30, cell8[4]- '0');
-    matrix.setPoint(5, 30, cell8[5]- '0');
-
-    //CELL9
-    matrix.setPoint(1, 17, cell9[0]- '0');
-    matrix.setPoint(3, 17, cell9[1]- '0');
-    matrix.setPoint(5, 17, cell9[2]- '0');
-
-    matrix.setPoint(1, 19, cell9[3]- '0');
-    matrix.setPoint(3, 19, cell9[4]- '0');
-    matrix.setPoint(5, 19, cell9[5]- '0');
-
-    //CELL10
-    matrix.setPoint(1, 22, cell10[0]- '0');
-    matrix.setPoint(3, 22, cell10[1]- '0');
-    matrix.setPoint(5, 22, cell10[2]- '0');
-
-    matrix.setPoint(1, 8, cell10[3]- '0');
-    matrix.setPoint(3, 8, cell10[4]- '0');
-    matrix.setPoint(5, 8, cell10[5]- '0');
-
-    //CELL11
-    matrix.setPoint(1, 11, cell11[0]- '0');
-    matrix.setPoint(3, 11, cell11[1]- '0');
-    matrix.setPoint(5, 11, cell11[2]- '0');
-
-    matrix.setPoint(1, 13, cell11[3]- '0');
-    matrix.setPoint(3, 13, cell11[4]- '0');
-    matrix.setPoint(5, 13, cell11[5]- '0');
-
-    //CELL12
-    matrix.setPoint(1, 0, cell12[0]- '0');
-    matrix.setPoint(3, 0, cell12[1]- '0');
-    matrix.setPoint(5, 0, cell12[2]- '0');
-
-    matrix.setPoint(1, 2, cell12[3]- '0');
-    matrix.setPoint(3, 2, cell12[4]- '0');
-    matrix.setPoint(5, 2, cell12[5]- '0');
-
-    //CELL12
-    matrix.setPoint(1, 5, cell12[0]- '0');
-    matrix.setPoint(3, 5, cell12[1]- '0');
-    matrix.setPoint(5, 5, cell12[2]- '0');
-
-    matrix.setPoint(1, 7, cell12[3]- '0');
-    matrix.setPoint(3, 7, cell12[4]- '0');
-    matrix.setPoint(5, 7, cell12[5]- '0');
+
+//translates the shown list again and stays on the same item if it is still there
+void rebuildMenu(){
+  const MenuNode &was = menu.current();
+  uint8_t kind = was.kind;
+  uint8_t length = was.length;
+  uint8_t cells[255];
+  memcpy(cells, menu.cells(was), length);
+
+  if(!menu.build(*shownList, table)){
+    trace(TRACE_MENU_FULL);
+  }
+  latency.stamp(STAGE_TRANSLATE);
+  uint16_t at = menu.find(kind, cells, length);
+  if(at != NO_NODE) menu.select(at);
+  selectNode();
+  showLine();
+}
+
+//NEXT/PREV pan through a long name and then move to the next/previous item (holding them keeps
+//going), ENTER opens a room or device or runs an action, BACK goes up a level.
+//True if the line has to be redrawn.
+bool handleButton(const ButtonEvent &event){
+  switch(event.button){
+    case BUTTON_NEXT:
+      if(line.panRight()) return true;
+      if(!menu.next()) return false;
+      selectNode();
+      return true;
+    case BUTTON_PREV:
+      if(line.panLeft()) return true;
+      if(!menu.prev()) return false;
+      selectNode();
+      return true;
+    case BUTTON_BACK:
+      if(event.type != BUTTON_PRESS) return false;
+      if(!menu.back()) return line.home();
+      selectNode();
+      return true;
+    case BUTTON_ENTER:
+      if(event.type != BUTTON_PRESS) return false;
+      if(menu.current().kind == MENU_ACTION){
+        runAction(menu.current());
+        return false;
+      }
+      if(!menu.enter()) return false;
+      selectNode();
+      return true;
+  }
+  return false;
+}
+
+//builds the menu from list; the list shown before that can be filled again
+void showDevices(DeviceList &list){
+  trace(TRACE_DEVICE_LIST, list.rooms > 255 ? 255 : list.rooms, list.count);
+  if(!menu.build(list, table)){
+    trace(TRACE_MENU_FULL);
+  }
+  latency.stamp(STAGE_TRANSLATE);
+  if(shownList != nullptr && shownList != &bootList){
+    releaseDeviceList(shownList);
+  }
+  shownList = &list;
+  selectNode();
+  showLine();
+}
+
+//grade 1 -> grade 2 -> computer braille, the menu is translated again and stays on the same item
+void nextTable(){
+  table = (table + 1) % TABLE_COUNT;
+  trace(TRACE_GRADE, table);
+  uint16_t at = menu.currentIndex();
+  menu.build(*shownList, table);
+  menu.select(at);
+  selectNode();
+  showLine();
+  saveMenu();
+}
+
+//after the dots are up, the flash write holds the ui task for a few ms
+void saveMenu(){
+  if(showingDemo) return;
+  trace(TRACE_CACHE_SAVED, menuCacheSave(*shownList, menu, table));
+}
+
+void runAction(const MenuNode &node){
+  const MenuNode &device = menu.node(node.parent);
+  //the topic is copied now, the list can change under the network task before it publishes
+  const DeviceEntry &e = shownList->entry[device.item];
+  NetCommand command = {NET_DEVICE_ACTION};
+  command.action = (uint8_t)node.item;
+  bool fits = e.room.len + 1 + e.device.len < sizeof(command.topic);
+  if(fits){
+    memcpy(command.topic, shownList->at(e.room), e.room.len);
+    command.topic[e.room.len] = '/';
+    memcpy(command.topic + e.room.len + 1, shownList->at(e.device), e.device.len);
+    command.topic[e.room.len + 1 + e.device.len] = '\0';
+  }
+  if(fits && sendNetCommand(command)){
+    trace(TRACE_ACTION, node.item, device.item);
+  }else{
+    trace(TRACE_ACTION_OFFLINE, node.item, device.item);
+    attention = true;
+    renderer->setOverlay(panel->cells - 1, 0xFF, ATTENTION_BLINK_MS, phaseNow(ATTENTION_BLINK_MS));
+  }
+}
+
+//the line shows the current item's cells straight from the menu, nothing is translated
+void selectNode(){
+  line.showCells(menu.cells(menu.current()), menu.current().length);
+  showStatus();
+}
+
+//the mark under the first cell; a status change only has to call this, the next refresh shows it
+void showStatus(){
+  const MenuNode &node = menu.current();
+  if(node.kind == MENU_ACTION){
+    renderer->setOverlay(0, CURSOR_DOTS, CURSOR_BLINK_MS, phaseNow(CURSOR_BLINK_MS));
+    return;
+  }
+  bool on = node.kind == MENU_DEVICE && menu.list()->entry[node.item].status == STATUS_ON;
+  renderer->setOverlay(0, on ? STATUS_ON_DOTS : 0);
+}
+
+//the phase that starts a blink's on time now, so a mark shows up as soon as it is set
+uint16_t phaseNow(uint16_t periodMs){
+  return 2 * periodMs - millis() % (2 * periodMs);
+}
+
+void showLine(){
+  uint8_t changed = renderer->commit(line.visible(), line.visibleCount());
+  trace(TRACE_LINE, changed, line.offset());
+  latency.stamp(STAGE_BUFFER, renderer->bufferedAt());
+  latency.stamp(STAGE_SPI, renderer->sentAt());
+  latency.finish();
 }
@@ -5,6 +5,7 @@ const mqtt = require('mqtt');
 const cors = require('cors');
 
 const Device = require('./models/Device');
+const catalogue = require('./services/deviceCatalogue');
 const deviceRoutes = require('./routes/devices');
 const routineRoutes = require('./routes/routines');
 
@@ -34,16 +35,62 @@ mqttClient.on('connect', () => {
     if (err) console.error('Failed to subscribe:', err);
     else console.log(`Subscribed to "${REQ_TOPIC}"`);
   });
+  statusTopics.clear(); // a new session doesn't keep the old subscriptions
+  catalogue.refresh()
+    .then(subscribeStatus)
+    .catch(err => console.error('Failed to fetch devices:', err));
 });
 
 mqttClient.on('error', (err) => {
   console.error('MQTT error:', err);
 });
 
+// --- Device status, so the displays get it with their list ---
+// Every device's status topic, subscribed once the catalogue knows it.
+const statusTopics = new Set();
+function subscribeStatus() {
+  catalogue.statusTopics().forEach(topic => {
+    if (statusTopics.has(topic)) return;
+    statusTopics.add(topic);
+    mqttClient.subscribe(topic, (err) => {
+      if (err) {
+        console.error(`Failed to subscribe to ${topic}:`, err);
+        statusTopics.delete(topic);
+      }
+    });
+  });
+}
+
+// --- Versioned requests: "since <epoch> <version> <client>" ---
+// The reply goes to deviceList/response/<client> only, in the binary format of
+// services/wireFormat.js: up to date, the changes since the display's version, or a snapshot
+// when it is too far behind (see services/deviceCatalogue.js).
+async function replySince(request) {
+  const [, epoch, version, client] = request.split(' ');
+  if (!client || !/^[\w-]+$/.test(client)) return;
+
+  const topic = `${RES_TOPIC}/${client}`;
+  try {
+    const reply = await catalogue.reply(Number(epoch), Number(version));
+    mqttClient.publish(topic, reply, { qos: 0 }, (err) => {
+      if (err) console.error('Publish error:', err);
+      else console.log(`Published ${reply.length} bytes to ${topic}`);
+    });
+    subscribeStatus();
+  } catch (e) {
+    console.error('Failed to fetch/publish devices:', e);
+    mqttClient.publish(topic, `ERROR: ${e.message || 'Unknown error'}`, { qos: 0 });
+  }
+}
+
 // --- Handle incoming deviceList requests ---
 mqttClient.on('message', async (topic, payload) => {
+  if (statusTopics.has(topic)) catalogue.setStatus(topic, payload);
   if (topic !== REQ_TOPIC) return;
 
+  const request = payload.toString();
+  if (request.startsWith('since ')) return replySince(request);
+
   try {
     const devices = await Device.find().lean();
 
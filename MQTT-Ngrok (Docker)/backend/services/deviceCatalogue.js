@@ -0,0 +1,119 @@
+const Device = require('../models/Device');
+const wire = require('./wireFormat');
+
+//how many changes are kept; a display further behind than that gets a snapshot
+const LOG_LIMIT = 256;
+
+//The room/device names the displays show, with a version that goes up by one on every change
+//and a log of the last changes, so a display can ask for "changes since N" instead of the
+//whole list. The epoch is the start time of this process: versions from another run are
+//never mixed up with ours, a display that sends one just gets a snapshot. The last status each
+//device reported on its status topic is kept too, a change of it is logged like any other.
+class DeviceCatalogue {
+    constructor() {
+        this.epoch = Math.floor(Date.now() / 1000);
+        this.version = 0;
+        this.devices = new Map(); //_id -> { room, device, statusTopic, status, battery }, in database order
+        this.log = [];            //{ version, op: '+' | '-' | '~' | '!', before, after }
+        this.refreshing = null;
+    }
+
+    //Reads the devices again and logs whatever changed since the last time, so edits from the
+    //REST API, the web app or straight in Mongo are all picked up. Calls overlapping each other
+    //share one database query.
+    refresh() {
+        if (!this.refreshing) {
+            this.refreshing = this._refresh().finally(() => {
+                this.refreshing = null;
+            });
+        }
+        return this.refreshing;
+    }
+
+    async _refresh() {
+        const devices = await Device.find().lean();
+        const seen = new Set();
+
+        for (const d of devices) {
+            const id = d._id.toString();
+            const old = this.devices.get(id);
+            const entry = {
+                room: d.roomName || 'Unassigned',
+                device: d.deviceName,
+                statusTopic: d.deviceStatusTopic,
+                status: old ? old.status : wire.UNKNOWN,
+                battery: old ? old.battery : undefined,
+            };
+            seen.add(id);
+
+            if (!old) {
+                this._record('+', null, entry);
+            } else if (old.room !== entry.room || old.device !== entry.device) {
+                this._record('~', old, entry);
+            } else if (old.statusTopic === entry.statusTopic) {
+                continue;
+            }
+            this.devices.set(id, entry);
+        }
+
+        for (const [id, old] of this.devices) {
+            if (seen.has(id)) continue;
+            this._record('-', old, null);
+            this.devices.delete(id);
+        }
+    }
+
+    //Takes a message from a device's status topic, binary or JSON. The entry is replaced rather
+    //than changed, the log still holds the old one.
+    setStatus(topic, payload) {
+        const report = wire.decodeStatus(payload);
+        if (!report) return false;
+        for (const [id, old] of this.devices) {
+            if (old.statusTopic !== topic) continue;
+            if (old.status === report.status && old.battery === report.battery) continue;
+            const entry = { ...old, status: report.status, battery: report.battery };
+            this._record('!', old, entry);
+            this.devices.set(id, entry);
+        }
+        return true;
+    }
+
+    statusTopics() {
+        return [...new Set([...this.devices.values()].map(e => e.statusTopic).filter(Boolean))];
+    }
+
+    _record(op, before, after) {
+        this.version++;
+        this.log.push({ version: this.version, op, before, after });
+        if (this.log.length > LOG_LIMIT) this.log.shift();
+    }
+
+    //Changes after (epoch, version) as they were logged, null if they aren't all in the log
+    //any more.
+    changesSince(epoch, version) {
+        if (epoch !== this.epoch || version > this.version) return null;
+        if (version === this.version) return [];
+
+        const first = this.log.length ? this.log[0].version : this.version + 1;
+        if (version < first - 1) return null;
+        return this.log.filter(change => change.version > version);
+    }
+
+    //What a display that has (epoch, version) should get, binary (services/wireFormat.js): that
+    //it is up to date, the changes to apply to the list it has, or a snapshot to replace it with,
+    //whichever of the last two is shorter.
+    async reply(epoch, version) {
+        await this.refresh();
+        const changes = this.changesSince(epoch, version);
+
+        if (changes && changes.length === 0) return wire.encodeVersion(this.epoch, this.version);
+
+        const snapshot = wire.encodeSnapshot(this.epoch, this.version, [...this.devices.values()]);
+        if (!changes) return snapshot;
+
+        const delta = wire.encodeDelta(this.epoch, version, this.version, changes);
+        return delta.length < snapshot.length ? delta : snapshot;
+    }
+}
+
+module.exports = new DeviceCatalogue();
@@ -0,0 +1,152 @@
+//Binary replies for the displays, see include/WireFormat.h in the firmware for the layout.
+//Names are written with a length byte in front instead of between separators, so a name with
+//'-', ';' or ',' in it is just a name, and a snapshot sends every room name once, in front of its
+//devices.
+
+const MAGIC = [0xb1, 0x4c];
+const FORMAT = 1;
+const HEADER = 20;
+
+const KIND = { version: 0, snapshot: 1, delta: 2, status: 3 };
+const OP = { '+': 1, '-': 2, '~': 3, '!': 4 };
+
+const STATUS_OFF = 0;
+const STATUS_ON = 1;
+const UNKNOWN = 0xff; //status or battery nobody has reported
+
+const NAME_MAX = 255;
+
+//UTF-8 bytes of a name, cut to what a length byte can count without splitting a character
+function nameBytes(name) {
+    const bytes = Buffer.from(String(name), 'utf8');
+    if (bytes.length <= NAME_MAX) return bytes;
+    let end = NAME_MAX;
+    while (end > 0 && (bytes[end] & 0xc0) === 0x80) end--;
+    return bytes.subarray(0, end);
+}
+
+//collects the pieces of a message and joins them once at the end
+class Writer {
+    constructor() {
+        this.parts = [];
+    }
+
+    bytes(...values) {
+        this.parts.push(Buffer.from(values));
+    }
+
+    name(name) {
+        const bytes = nameBytes(name);
+        this.bytes(bytes.length);
+        this.parts.push(bytes);
+    }
+
+    header(kind, epoch, version, base, rooms, records) {
+        const h = Buffer.alloc(HEADER);
+        h[0] = MAGIC[0];
+        h[1] = MAGIC[1];
+        h[2] = FORMAT;
+        h[3] = kind;
+        h.writeUInt32LE(epoch >>> 0, 4);
+        h.writeUInt32LE(version >>> 0, 8);
+        h.writeUInt32LE(base >>> 0, 12);
+        h.writeUInt16LE(rooms, 16);
+        h.writeUInt16LE(records, 18);
+        this.parts.push(h);
+    }
+
+    done() {
+        return Buffer.concat(this.parts);
+    }
+}
+
+function statusByte(status) {
+    return status === STATUS_ON || status === STATUS_OFF ? status : UNKNOWN;
+}
+
+function batteryByte(battery) {
+    return Number.isInteger(battery) && battery >= 0 && battery <= 100 ? battery : UNKNOWN;
+}
+
+function encodeVersion(epoch, version) {
+    const w = new Writer();
+    w.header(KIND.version, epoch, version, 0, 0, 0);
+    return w.done();
+}
+
+//devices: [{ room, device, status, battery }], each room is named once and followed by its
+//devices, rooms in the order they first appear
+function encodeSnapshot(epoch, version, devices) {
+    const rooms = new Map(); //room -> its devices
+    for (const d of devices) {
+        if (!rooms.has(d.room)) rooms.set(d.room, []);
+        rooms.get(d.room).push(d);
+    }
+
+    const w = new Writer();
+    w.header(KIND.snapshot, epoch, version, 0, rooms.size, devices.length);
+    for (const [room, inRoom] of rooms) {
+        if (inRoom.length > 255) throw new Error(`${inRoom.length} devices in ${room}, a snapshot can count 255`);
+        w.name(room);
+        w.bytes(inRoom.length);
+        for (const d of inRoom) {
+            w.bytes(statusByte(d.status), batteryByte(d.battery));
+            w.name(d.device);
+        }
+    }
+    return w.done();
+}
+
+//changes: [{ op, before, after }] as deviceCatalogue logs them
+function encodeDelta(epoch, base, version, changes) {
+    const w = new Writer();
+    w.header(KIND.delta, epoch, version, base, 0, changes.length);
+    for (const { op, before, after } of changes) {
+        w.bytes(OP[op]);
+        const first = op === '+' || op === '!' ? after : before;
+        w.name(first.room);
+        w.name(first.device);
+        if (op === '~') {
+            w.name(after.room);
+            w.name(after.device);
+        } else if (op !== '-') {
+            w.bytes(statusByte(after.status), batteryByte(after.battery));
+        }
+    }
+    return w.done();
+}
+
+//what a device can publish on its status topic instead of {"status":"ON","battery":80}
+function encodeStatus(on, battery) {
+    const w = new Writer();
+    w.bytes(MAGIC[0], MAGIC[1], FORMAT, KIND.status, on ? STATUS_ON : STATUS_OFF, batteryByte(battery));
+    return w.done();
+}
+
+//A status message in either form: { status: STATUS_ON | STATUS_OFF | UNKNOWN, battery }, battery
+//undefined if there is none. null if it is neither.
+function decodeStatus(payload) {
+    const b = Buffer.isBuffer(payload) ? payload : Buffer.from(payload);
+    if (b.length === 6 && b[0] === MAGIC[0] && b[1] === MAGIC[1] && b[2] === FORMAT && b[3] === KIND.status) {
+        return { status: statusByte(b[4]), battery: b[5] === UNKNOWN ? undefined : b[5] };
+    }
+    try {
+        const json = JSON.parse(b.toString());
+        const text = String(json.status).toUpperCase();
+        const status = text === 'ON' ? STATUS_ON : text === 'OFF' ? STATUS_OFF : UNKNOWN;
+        return { status, battery: typeof json.battery === 'number' ? Math.round(json.battery) : undefined };
+    } catch (e) {
+        return null;
+    }
+}
+
+module.exports = {
+    STATUS_OFF,
+    STATUS_ON,
+    UNKNOWN,
+    encodeVersion,
+    encodeSnapshot,
+    encodeDelta,
+    encodeStatus,
+    decodeStatus,
+};
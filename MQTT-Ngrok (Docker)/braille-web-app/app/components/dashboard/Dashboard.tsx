@@ -52,6 +52,18 @@ interface StatusResponse {
 
 const API_BASE = "https://braillink-api.ngrok.app/api";
 
+// Binary status frame (backend/services/wireFormat.js): B1 4C, format 1, kind 3, status, battery.
+// Status 1 is on, battery 0xFF means none.
+const parseStatus = (message: Uint8Array): StatusResponse => {
+    if (message.length === 6 && message[0] === 0xb1 && message[1] === 0x4c && message[2] === 1 && message[3] === 3) {
+        return {
+            status: message[4] === 1 ? "ON" : "OFF",
+            battery: message[5] === 0xff ? undefined : message[5]
+        };
+    }
+    return JSON.parse(new TextDecoder().decode(message));
+};
+
 const Dashboard: React.FC = () => {
     const [activeTab, setActiveTab] = useState<TabType>('dashboard');
     const [devices, setDevices] = useState<Device[]>([]);
@@ -147,7 +159,7 @@ const Dashboard: React.FC = () => {
         client.on('message', (topic, message) => {
             try {
                 console.log('📨 MQTT message received:', topic, message.toString());
-                const statusResponse: StatusResponse = JSON.parse(message.toString());
+                const statusResponse = parseStatus(message);
                 const isOn = statusResponse.status === 'ON' || statusResponse.status === 'on';
                 const battery = statusResponse.battery;
 